@@ -79,6 +79,7 @@ if ! $skip_gnulib; then
       basename
       closeout
       error
+      getdelim
       getopt-gnu
       gettext-h
       havelib
@@ -66,15 +66,52 @@ gl_rwlock_define (extern, _nl_state_lock attribute_hidden)
 # define BIND_TEXTDOMAIN_CODESET libintl_bind_textdomain_codeset
 #endif
 
-/* Specifies the directory name *DIRNAMEP and the output codeset *CODESETP
-   to be used for the DOMAINNAME message catalog.
+/* Return a copy of the NULL terminated list LAYERS, in a single memory
+   block, or NULL if LAYERS is empty or memory was exhausted.  */
+static char **
+copy_layers (const char * const *layers)
+{
+  size_t n;
+  size_t size;
+  char **result;
+
+  size = sizeof (char *);
+  for (n = 0; layers[n] != NULL; n++)
+    size += sizeof (char *) + strlen (layers[n]) + 1;
+  if (n == 0)
+    return NULL;
+
+  result = (char **) malloc (size);
+  if (__builtin_expect (result != NULL, 1))
+    {
+      char *p = (char *) (result + n + 1);
+      size_t i;
+
+      for (i = 0; i < n; i++)
+	{
+	  size_t len = strlen (layers[i]) + 1;
+
+	  result[i] = (char *) memcpy (p, layers[i], len);
+	  p += len;
+	}
+      result[n] = NULL;
+    }
+  return result;
+}
+
+/* Specifies the directory name *DIRNAMEP, the output codeset *CODESETP
+   and the list of layers *LAYERSP to be used for the DOMAINNAME message
+   catalog.
    If *DIRNAMEP or *CODESETP is NULL, the corresponding attribute is not
    modified, only the current value is returned.
-   If DIRNAMEP or CODESETP is NULL, the corresponding attribute is neither
-   modified nor returned.  */
+   If DIRNAMEP, CODESETP or LAYERSP is NULL, the corresponding attribute is
+   neither modified nor returned.
+   An empty list *LAYERSP turns DOMAINNAME into an ordinary domain.  If the
+   list of layers cannot be stored, *LAYERSP is set to NULL.  */
 static void
 set_binding_values (const char *domainname,
-		    const char **dirnamep, const char **codesetp)
+		    const char **dirnamep, const char **codesetp,
+		    const char * const **layersp)
 {
   struct binding *binding;
   int modified;
@@ -86,6 +123,8 @@ set_binding_values (const char *domainname,
 	*dirnamep = NULL;
       if (codesetp)
 	*codesetp = NULL;
+      if (layersp)
+	*layersp = NULL;
       return;
     }
 
@@ -186,9 +225,25 @@ set_binding_values (const char *domainname,
 	      *codesetp = result;
 	    }
 	}
+
+      if (layersp)
+	{
+	  char **result = copy_layers (*layersp);
+
+	  if (__builtin_expect (result != NULL || (*layersp)[0] == NULL, 1))
+	    {
+	      free (binding->layers);
+
+	      binding->layers = result;
+	      modified = 1;
+	    }
+	  else
+	    *layersp = NULL;
+	}
     }
   else if ((dirnamep == NULL || *dirnamep == NULL)
-	   && (codesetp == NULL || *codesetp == NULL))
+	   && (codesetp == NULL || *codesetp == NULL)
+	   && layersp == NULL)
     {
       /* Simply return the default values.  */
       if (dirnamep)
@@ -270,6 +325,16 @@ set_binding_values (const char *domainname,
       else
 	new_binding->codeset = NULL;
 
+      new_binding->layers = NULL;
+      if (layersp)
+	{
+	  char **result = copy_layers (*layersp);
+
+	  if (__builtin_expect (result == NULL && (*layersp)[0] != NULL, 0))
+	    goto failed_layers;
+	  new_binding->layers = result;
+	}
+
       /* Now enqueue it.  */
       if (_nl_domain_bindings == NULL
 	  || strcmp (domainname, _nl_domain_bindings->domainname) < 0)
@@ -293,6 +358,8 @@ set_binding_values (const char *domainname,
       /* Here we deal with memory allocation failures.  */
       if (0)
 	{
+	failed_layers:
+	  free (new_binding->codeset);
 	failed_codeset:
 	  if (new_binding->dirname != _nl_default_dirname)
 	    free (new_binding->dirname);
@@ -303,6 +370,8 @@ set_binding_values (const char *domainname,
 	    *dirnamep = NULL;
 	  if (codesetp)
 	    *codesetp = NULL;
+	  if (layersp)
+	    *layersp = NULL;
 	}
     }
 
@@ -318,7 +387,7 @@ set_binding_values (const char *domainname,
 char *
 BINDTEXTDOMAIN (const char *domainname, const char *dirname)
 {
-  set_binding_values (domainname, &dirname, NULL);
+  set_binding_values (domainname, &dirname, NULL, NULL);
   return (char *) dirname;
 }
 
@@ -327,10 +396,25 @@ BINDTEXTDOMAIN (const char *domainname, const char *dirname)
 char *
 BIND_TEXTDOMAIN_CODESET (const char *domainname, const char *codeset)
 {
-  set_binding_values (domainname, NULL, &codeset);
+  set_binding_values (domainname, NULL, &codeset, NULL);
   return (char *) codeset;
 }
 
+#ifndef _LIBC
+/* Specify that the messages of DOMAINNAME are to be looked up in the
+   domains LAYERS[0], LAYERS[1], ..., in this order, until a translation
+   is found.  */
+int
+libintl_bind_textdomain_layers (const char *domainname,
+				const char * const *layers)
+{
+  if (layers == NULL)
+    return -1;
+  set_binding_values (domainname, NULL, NULL, &layers);
+  return (layers != NULL ? 0 : -1);
+}
+#endif
+
 #ifdef _LIBC
 /* Aliases for function names in GNU C Library.  */
 weak_alias (__bindtextdomain, bindtextdomain);
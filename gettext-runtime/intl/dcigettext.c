@@ -58,6 +58,7 @@ extern int errno;
 #endif
 
 #include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -135,7 +136,6 @@ extern int errno;
 # ifndef stpcpy
 #  define stpcpy __stpcpy
 # endif
-# define tfind __tfind
 #else
 # if !defined HAVE_GETCWD
 char *getwd ();
@@ -155,22 +155,6 @@ static void *mempcpy (void *dest, const void *src, size_t n);
 # endif
 #endif
 
-/* Use a replacement if the system does not provide the `tsearch' function
-   family.  */
-#if HAVE_TSEARCH || defined _LIBC
-# include <search.h>
-#else
-# define tsearch libintl_tsearch
-# define tfind libintl_tfind
-# define tdelete libintl_tdelete
-# define twalk libintl_twalk
-# include "tsearch.h"
-#endif
-
-#ifdef _LIBC
-# define tsearch __tsearch
-#endif
-
 /* Amount to increase buffer size by in each try.  */
 #define PATH_INCR 32
 
@@ -230,10 +214,84 @@ static void *mempcpy (void *dest, const void *src, size_t n);
 # define HAVE_PER_THREAD_LOCALE
 #endif
 
-/* This is the type used for the search tree where known translations
-   are stored.  */
-struct known_translation_t
+/* The hash values of a message that its lookups use.  Each of them is
+   computed when it is first needed, so that a message that is looked up
+   in several message catalogs is hashed only once.  */
+struct msgid_hash
+{
+  /* The message.  */
+  const char *msgid;
+  /* Which of the values below are known: a combination of MSGID_HASH_LEN,
+     MSGID_HASH_PJW and MSGID_HASH_MURMUR3.  */
+  int known;
+  /* The length of the message.  */
+  size_t len;
+  /* The value of __hash_string.  */
+  unsigned long int pjw;
+  /* The value of __hash_string_murmur3.  */
+  nls_uint32 murmur3;
+};
+
+#define MSGID_HASH_LEN 1
+#define MSGID_HASH_PJW 2
+#define MSGID_HASH_MURMUR3 4
+
+static inline void
+msgid_hash_init (struct msgid_hash *hash, const char *msgid)
+{
+  hash->msgid = msgid;
+  hash->known = 0;
+  hash->len = 0;
+  hash->pjw = 0;
+  hash->murmur3 = 0;
+}
+
+/* Return the length of the message of HASH.  */
+static inline size_t
+msgid_hash_len (struct msgid_hash *hash)
+{
+  if (!(hash->known & MSGID_HASH_LEN))
+    {
+      hash->len = strlen (hash->msgid);
+      hash->known |= MSGID_HASH_LEN;
+    }
+  return hash->len;
+}
+
+/* Return the value of __hash_string for the message of HASH.  */
+static inline unsigned long int
+msgid_hash_pjw (struct msgid_hash *hash)
+{
+  if (!(hash->known & MSGID_HASH_PJW))
+    {
+      hash->pjw = __hash_string (hash->msgid);
+      hash->known |= MSGID_HASH_PJW;
+    }
+  return hash->pjw;
+}
+
+/* Return the value of __hash_string_murmur3 for the message of HASH.  */
+static inline nls_uint32
+msgid_hash_murmur3 (struct msgid_hash *hash)
 {
+  if (!(hash->known & MSGID_HASH_MURMUR3))
+    {
+      hash->murmur3 =
+	__hash_string_murmur3 (hash->msgid, msgid_hash_len (hash));
+      hash->known |= MSGID_HASH_MURMUR3;
+    }
+  return hash->murmur3;
+}
+
+/* This is the type used for the lookup key of a known translation.  */
+struct known_translation_key
+{
+  /* Hash code of the key, computed by known_translation_hash.  */
+  unsigned long int hash;
+
+  /* The string in question.  */
+  const char *msgid;
+
   /* Domain in which to search.  */
   const char *domainname;
 
@@ -249,7 +307,16 @@ struct known_translation_t
   /* The character encoding.  */
   const char *encoding;
 #endif
+};
 
+/* Number of plural forms, after the first one, whose offset is stored
+   with the known translations.  */
+#define KNOWN_TRANSLATION_PLURAL_FORMS 4
+
+/* This is the part of a known translation that gets updated when the
+   catalogs change.  */
+struct known_translation_value
+{
   /* State of the catalog counter at the point the string was found.  */
   int counter;
 
@@ -260,57 +327,535 @@ struct known_translation_t
   const char *translation;
   size_t translation_length;
 
-  /* Pointer to the string in question.  */
-  union
-    {
-      char appended[ZERO];  /* used if domain != NULL */
-      const char *ptr;      /* used if domain == NULL */
-    }
-  msgid;
+  /* Offsets of the plural forms 1 to KNOWN_TRANSLATION_PLURAL_FORMS in
+     the translation, or 0 where not known.  */
+  unsigned short plural_offsets[KNOWN_TRANSLATION_PLURAL_FORMS];
 };
 
-gl_rwlock_define_initialized (static, tree_lock)
+/* This is the type used for the slots of the table where known translations
+   are stored.  The strings a slot points to are never freed while the
+   program runs: MSGID points into the message catalog, and DOMAINNAME and
+   LOCALENAME are interned.  Therefore readers can look at a slot without
+   taking a lock, even while another thread overwrites it.  */
+struct known_translation_t
+{
+  /* Sequence number.  It is odd while the slot is being written, so that
+     readers which don't take a lock can detect a torn read.  */
+  unsigned int seq;
+
+  /* The category.  */
+  int category;
+
+  /* Hash code of the key, computed by known_translation_hash.  */
+  unsigned long int hash;
 
-/* Root of the search tree with known translations.  */
-static void *root;
+  /* The string in question, or NULL if the slot is empty.  */
+  const char *msgid;
 
-/* Function to compare two entries in the table of known translations.  */
-static int
-transcmp (const void *p1, const void *p2)
+  /* Domain in which to search.  */
+  const char *domainname;
+
+#ifdef HAVE_PER_THREAD_LOCALE
+  /* Name of the relevant locale category, or "" for the global locale.  */
+  const char *localename;
+#endif
+
+#ifdef IN_LIBGLOCALE
+  /* The character encoding.  */
+  const char *encoding;
+#endif
+
+  struct known_translation_value value;
+};
+
+/* Number of slots in which a given key can be stored.  A lookup looks at
+   these slots only; when all of them are in use, the insertion of a new
+   key evicts one of them.  */
+#define KNOWN_TRANSLATION_WAYS 4
+
+/* Set-associative hash table with the known translations.
+   Lookups don't take a lock if HAVE_LOCKFREE_READERS.  Therefore a table,
+   once published, is never freed while the program runs.  */
+struct known_translation_table
+{
+  /* Number of slots, a power of 2 and at least KNOWN_TRANSLATION_WAYS.  */
+  size_t size;
+  /* Number of non-empty slots.  */
+  size_t filled;
+  /* Slot to evict next, within a set.  */
+  unsigned int victim;
+  /* The previous, smaller table.  Concurrent readers may still be
+     looking at it.  */
+  struct known_translation_table *previous;
+  /* The slots.  */
+  struct known_translation_t slots[ZERO];
+};
+
+/* Initial number of slots in the table of known translations.  */
+#define KNOWN_TRANSLATIONS_INITIAL_SIZE 64
+
+/* Default maximum number of slots in the table of known translations.  */
+#define KNOWN_TRANSLATIONS_DEFAULT_CAPACITY 65536
+
+/* Lock that serializes the modifications of the table of known
+   translations.  */
+gl_rwlock_define_initialized (static, known_translations_lock)
+
+/* The table with known translations.  */
+static struct known_translation_table *known_translations;
+
+/* Maximum number of slots in the table of known translations.  */
+static size_t known_translations_capacity =
+  KNOWN_TRANSLATIONS_DEFAULT_CAPACITY;
+
+/* Statistics about the table of known translations.  The hits and misses
+   are only counted on request, because counting them means a write to
+   shared memory in every lookup.  */
+static int known_translations_count_hits;
+static unsigned long int known_translations_hits;
+static unsigned long int known_translations_misses;
+static unsigned long int known_translations_evictions;
+
+/* A string that is kept for the lifetime of the program.  */
+struct known_translation_string
+{
+  struct known_translation_string *next;
+  char contents[ZERO];
+};
+
+/* The interned strings, in order of creation.  */
+static struct known_translation_string *known_translation_strings;
+
+/* Compute the hash code of the parts of a known translation key other
+   than its msgid.  */
+static inline unsigned long int
+known_translation_context_hash (const struct known_translation_key *key)
+{
+  unsigned long int hval = __hash_string (key->domainname);
+
+#ifdef HAVE_PER_THREAD_LOCALE
+  hval = (hval << 5) + hval + __hash_string (key->localename);
+#endif
+#ifdef IN_LIBGLOCALE
+  hval = (hval << 5) + hval + __hash_string (key->encoding);
+#endif
+  return hval + key->category;
+}
+
+/* Compute the hash code of a known translation key from the value of
+   __hash_string_murmur3 for its msgid, MSGID_HVAL, and the hash code of
+   its other parts, CONTEXT_HVAL.  All parts of the key enter it, so that
+   the translations of a message into several locales don't compete for
+   the same set of slots.  The msgid is hashed like for the lookup in a
+   message catalog, so that a lookup that misses the known translations
+   doesn't hash it again.  */
+static inline unsigned long int
+known_translation_hash (unsigned long int msgid_hval,
+			unsigned long int context_hval)
+{
+  return (msgid_hval << 5) + msgid_hval + context_hval;
+}
+
+/* Return a copy of STRING that is never freed while the program runs,
+   or NULL if memory was exhausted.
+   The caller must hold known_translations_lock for writing.  */
+static const char *
+known_translation_intern (const char *string)
+{
+  struct known_translation_string *p;
+  size_t len;
+
+  for (p = known_translation_strings; p != NULL; p = p->next)
+    if (strcmp (p->contents, string) == 0)
+      return p->contents;
+
+  len = strlen (string) + 1;
+  p = (struct known_translation_string *)
+      malloc (offsetof (struct known_translation_string, contents) + len);
+  if (p == NULL)
+    return NULL;
+  memcpy (p->contents, string, len);
+  p->next = known_translation_strings;
+  known_translation_strings = p;
+  return p->contents;
+}
+
+/* Copy the contents of SRC, except its sequence number, to DEST.  A reader
+   may copy a slot while a writer overwrites it, therefore the fields are
+   copied one by one, with atomic loads and stores.  */
+static inline void
+known_translation_copy (struct known_translation_t *dest,
+			const struct known_translation_t *src)
+{
+  int i;
+
+#define COPY_FIELD(field) \
+  ATOMIC_STORE_RELAXED (dest->field, ATOMIC_LOAD_RELAXED (src->field))
+  COPY_FIELD (category);
+  COPY_FIELD (hash);
+  COPY_FIELD (msgid);
+  COPY_FIELD (domainname);
+#ifdef HAVE_PER_THREAD_LOCALE
+  COPY_FIELD (localename);
+#endif
+#ifdef IN_LIBGLOCALE
+  COPY_FIELD (encoding);
+#endif
+  COPY_FIELD (value.counter);
+  COPY_FIELD (value.domain);
+  COPY_FIELD (value.translation);
+  COPY_FIELD (value.translation_length);
+  for (i = 0; i < KNOWN_TRANSLATION_PLURAL_FORMS; i++)
+    COPY_FIELD (value.plural_offsets[i]);
+#undef COPY_FIELD
+}
+
+/* Copy SLOT to *ENTRY.  Return 0 if this failed because another thread
+   was writing the slot at the same time.  */
+static inline int
+known_translation_read (const struct known_translation_t *slot,
+			struct known_translation_t *entry)
 {
-  const struct known_translation_t *s1;
-  const struct known_translation_t *s2;
-  int result;
+  unsigned int seq = ATOMIC_LOAD_ACQUIRE (slot->seq);
 
-  s1 = (const struct known_translation_t *) p1;
-  s2 = (const struct known_translation_t *) p2;
+  if (seq & 1)
+    return 0;
+  known_translation_copy (entry, slot);
+  ATOMIC_FENCE_ACQUIRE ();
+  return ATOMIC_LOAD_RELAXED (slot->seq) == seq;
+}
+
+/* Replace the contents of SLOT with *ENTRY.
+   The caller must hold known_translations_lock for writing.  */
+static void
+known_translation_write (struct known_translation_t *slot,
+			 const struct known_translation_t *entry)
+{
+  unsigned int seq = slot->seq;
+
+  ATOMIC_STORE_RELAXED (slot->seq, seq + 1);
+  ATOMIC_FENCE_RELEASE ();
+  known_translation_copy (slot, entry);
+  ATOMIC_STORE_RELEASE (slot->seq, seq + 2);
+}
+
+/* Fill in the plural form offsets of VALUE from its translation.  */
+static void
+known_translation_plural_offsets (struct known_translation_value *value)
+{
+  const char *translation = value->translation;
+  const char *end = translation + value->translation_length;
+  const char *p = translation;
+  size_t i;
 
-  result = strcmp (s1->domain != NULL ? s1->msgid.appended : s1->msgid.ptr,
-		   s2->domain != NULL ? s2->msgid.appended : s2->msgid.ptr);
-  if (result == 0)
+  for (i = 0; i < KNOWN_TRANSLATION_PLURAL_FORMS; i++)
     {
-      result = strcmp (s1->domainname, s2->domainname);
-      if (result == 0)
-	{
+      const char *nul = (const char *) memchr (p, '\0', end - p);
+
+      if (nul == NULL || nul + 1 >= end || nul + 1 - translation > 0xffff)
+	break;
+      p = nul + 1;
+      value->plural_offsets[i] = p - translation;
+    }
+  for (; i < KNOWN_TRANSLATION_PLURAL_FORMS; i++)
+    value->plural_offsets[i] = 0;
+}
+
+/* Return nonzero if ENTRY is stored under KEY.  */
+static inline int
+known_translation_matches (const struct known_translation_t *entry,
+			   const struct known_translation_key *key)
+{
+  return (entry->msgid != NULL
+	  && entry->hash == key->hash
+	  && entry->category == key->category
+	  && strcmp (entry->msgid, key->msgid) == 0
+	  && (entry->domainname == key->domainname
+	      || strcmp (entry->domainname, key->domainname) == 0)
 #ifdef HAVE_PER_THREAD_LOCALE
-	  result = strcmp (s1->localename, s2->localename);
-	  if (result == 0)
+	  && strcmp (entry->localename, key->localename) == 0
 #endif
-	    {
 #ifdef IN_LIBGLOCALE
-	      result = strcmp (s1->encoding, s2->encoding);
-	      if (result == 0)
+	  && strcmp (entry->encoding, key->encoding) == 0
 #endif
-		/* We compare the category last (though this is the cheapest
-		   operation) since it is hopefully always the same (namely
-		   LC_MESSAGES).  */
-		result = s1->category - s2->category;
-	    }
+	  );
+}
+
+/* Return the set of slots in TABLE where an entry with hash code HASH
+   is stored.  */
+static inline struct known_translation_t *
+known_translation_set (struct known_translation_table *table,
+		       unsigned long int hash)
+{
+  return &table->slots[(hash * KNOWN_TRANSLATION_WAYS) & (table->size - 1)];
+}
+
+/* Look up KEY in TABLE.  Return the slot and copy its contents to *ENTRY,
+   or return NULL if not found.  */
+static struct known_translation_t *
+known_translation_find (struct known_translation_table *table,
+			const struct known_translation_key *key,
+			struct known_translation_t *entry)
+{
+  if (table != NULL)
+    {
+      struct known_translation_t *set =
+	known_translation_set (table, key->hash);
+      int i;
+
+      for (i = 0; i < KNOWN_TRANSLATION_WAYS; i++)
+	if (ATOMIC_LOAD_RELAXED (set[i].hash) == key->hash
+	    && known_translation_read (&set[i], entry)
+	    && known_translation_matches (entry, key))
+	  return &set[i];
+    }
+
+  return NULL;
+}
+
+/* Store ENTRY in an empty slot of TABLE.  Return 0 if there was none.
+   The caller must hold known_translations_lock for writing.  */
+static int
+known_translation_store (struct known_translation_table *table,
+			 const struct known_translation_t *entry)
+{
+  struct known_translation_t *set = known_translation_set (table, entry->hash);
+  int i;
+
+  for (i = 0; i < KNOWN_TRANSLATION_WAYS; i++)
+    if (set[i].msgid == NULL)
+      {
+	known_translation_write (&set[i], entry);
+	table->filled++;
+	return 1;
+      }
+
+  return 0;
+}
+
+/* Store ENTRY in TABLE in place of another entry.
+   The caller must hold known_translations_lock for writing.  */
+static void
+known_translation_evict (struct known_translation_table *table,
+			 const struct known_translation_t *entry)
+{
+  struct known_translation_t *set = known_translation_set (table, entry->hash);
+
+  known_translation_write (&set[table->victim], entry);
+  table->victim = (table->victim + 1) % KNOWN_TRANSLATION_WAYS;
+  known_translations_evictions++;
+}
+
+/* Replace the table of known translations with a table of NEW_SIZE slots,
+   and copy the entries over as far as they fit.  Return 0 if memory was
+   exhausted.
+   The caller must hold known_translations_lock for writing.  */
+static int
+known_translation_resize (size_t new_size)
+{
+  struct known_translation_table *table = known_translations;
+  struct known_translation_table *new_table =
+    (struct known_translation_table *)
+    calloc (1, offsetof (struct known_translation_table, slots)
+	       + new_size * sizeof (struct known_translation_t));
+
+  if (new_table == NULL)
+    return 0;
+
+  new_table->size = new_size;
+  new_table->previous = table;
+  if (table != NULL)
+    {
+      size_t i;
+
+      for (i = 0; i < table->size; i++)
+	if (table->slots[i].msgid != NULL
+	    && !known_translation_store (new_table, &table->slots[i]))
+	  known_translations_evictions++;
+    }
+
+  /* Publish the new table.  */
+  ATOMIC_STORE_RELEASE (known_translations, new_table);
+
+  return 1;
+}
+
+/* Return nonzero if all slots of the set for ENTRY in TABLE hold entries
+   with the same hash code as ENTRY.  A larger table would put them into
+   one set again.  */
+static int
+known_translation_set_collides (struct known_translation_table *table,
+				const struct known_translation_t *entry)
+{
+  struct known_translation_t *set = known_translation_set (table, entry->hash);
+  int i;
+
+  for (i = 0; i < KNOWN_TRANSLATION_WAYS; i++)
+    if (set[i].hash != entry->hash)
+      return 0;
+  return 1;
+}
+
+/* Add ENTRY to the table of known translations.  The table grows when
+   the set of slots for ENTRY is full, until it reaches its capacity;
+   then, or when growing would not help, another entry of the set is
+   evicted.
+   The caller must hold known_translations_lock for writing.  */
+static void
+known_translation_insert (const struct known_translation_t *entry)
+{
+  struct known_translation_table *table = known_translations;
+
+  for (;;)
+    {
+      size_t new_size;
+
+      if (table != NULL)
+	{
+	  if (known_translation_store (table, entry))
+	    return;
+	  if (table->size >= known_translations_capacity
+	      || known_translation_set_collides (table, entry))
+	    break;
 	}
+
+      new_size =
+	(table != NULL ? 2 * table->size : KNOWN_TRANSLATIONS_INITIAL_SIZE);
+      if (new_size > known_translations_capacity)
+	new_size = known_translations_capacity;
+      if (!known_translation_resize (new_size))
+	break;
+      table = known_translations;
     }
 
-  return result;
+  if (table != NULL)
+    known_translation_evict (table, entry);
+}
+
+#ifdef HAVE_PER_THREAD_LOCALE
+/* Look up KEY among the known translations, and store a copy of its entry
+   in *ENTRY.  Return nonzero if it was found and the catalogs have not
+   changed since.  */
+static int
+known_translation_lookup (const struct known_translation_key *key,
+			  struct known_translation_t *entry)
+{
+  int found;
+
+# ifndef HAVE_LOCKFREE_READERS
+  gl_rwlock_rdlock (known_translations_lock);
+# endif
+
+  found = (known_translation_find (ATOMIC_LOAD_ACQUIRE (known_translations),
+				   key, entry) != NULL
+	   && entry->value.counter == ATOMIC_LOAD_RELAXED (_nl_msg_cat_cntr));
+
+# ifndef HAVE_LOCKFREE_READERS
+  gl_rwlock_unlock (known_translations_lock);
+# endif
+
+  if (ATOMIC_LOAD_RELAXED (known_translations_count_hits))
+    {
+      if (found)
+	ATOMIC_INCREMENT_RELAXED (known_translations_hits);
+      else
+	ATOMIC_INCREMENT_RELAXED (known_translations_misses);
+    }
+
+  return found;
+}
+
+/* Remember that the message of KEY was found in DOMAIN, as FOUND_MSGID,
+   with the TRANSLATION_LENGTH bytes at TRANSLATION as translation.  */
+static void
+known_translation_remember (const struct known_translation_key *key,
+			    const char *found_msgid,
+			    struct loaded_l10nfile *domain,
+			    const char *translation,
+			    size_t translation_length)
+{
+  struct known_translation_t entry;
+
+  gl_rwlock_wrlock (known_translations_lock);
+
+  entry.hash = key->hash;
+  entry.msgid = found_msgid;
+  entry.domainname = known_translation_intern (key->domainname);
+  entry.category = key->category;
+  entry.localename = known_translation_intern (key->localename);
+# ifdef IN_LIBGLOCALE
+  entry.encoding = key->encoding;
+# endif
+  entry.value.counter = _nl_msg_cat_cntr;
+  entry.value.domain = domain;
+  entry.value.translation = translation;
+  entry.value.translation_length = translation_length;
+  known_translation_plural_offsets (&entry.value);
+
+  if (entry.domainname != NULL && entry.localename != NULL)
+    {
+      struct known_translation_t old_entry;
+      struct known_translation_t *slot;
+
+      /* Maybe in the meantime another thread has added
+	 the entry.  Recheck.  */
+      slot = known_translation_find (known_translations, key, &old_entry);
+      if (slot != NULL)
+	/* We can update the existing entry.  */
+	known_translation_write (slot, &entry);
+      else
+	known_translation_insert (&entry);
+    }
+
+  gl_rwlock_unlock (known_translations_lock);
+}
+#endif
+
+#if !defined _LIBC && !defined IN_LIBGLOCALE
+/* Set the maximum number of entries in the table of known translations.  */
+void
+libintl_set_cache_capacity (size_t capacity)
+{
+  size_t new_capacity;
+
+  if (capacity == 0)
+    new_capacity = KNOWN_TRANSLATIONS_DEFAULT_CAPACITY;
+  else
+    {
+      /* Round up to a power of 2.  */
+      new_capacity = KNOWN_TRANSLATION_WAYS;
+      while (new_capacity < capacity && new_capacity <= (size_t)(-1) / 2)
+	new_capacity *= 2;
+    }
+
+  gl_rwlock_wrlock (known_translations_lock);
+  known_translations_capacity = new_capacity;
+  if (known_translations != NULL && known_translations->size > new_capacity)
+    known_translation_resize (new_capacity);
+  gl_rwlock_unlock (known_translations_lock);
+}
+
+/* Enable or disable the counting of cache hits.  */
+void
+libintl_count_cache_hits (int enable)
+{
+  ATOMIC_STORE_RELAXED (known_translations_count_hits, enable != 0);
+}
+
+/* Return statistics about the table of known translations.  */
+void
+libintl_get_cache_stats (struct libintl_cache_stats *statsp)
+{
+  gl_rwlock_rdlock (known_translations_lock);
+  statsp->hits = ATOMIC_LOAD_RELAXED (known_translations_hits);
+  statsp->misses = ATOMIC_LOAD_RELAXED (known_translations_misses);
+  statsp->evictions = known_translations_evictions;
+  statsp->entries =
+    (known_translations != NULL ? known_translations->filled : 0);
+  statsp->capacity = known_translations_capacity;
+  gl_rwlock_unlock (known_translations_lock);
 }
+#endif
 
 /* Name of the default domain used for gettext(3) prior any call to
    textdomain(3).  The default value for this is "messages".  */
@@ -343,9 +888,22 @@ struct binding *_nl_domain_bindings;
 #endif
 
 /* Prototypes for local functions.  */
+#ifdef IN_LIBGLOCALE
+static char *find_msg (struct loaded_l10nfile *domain_file,
+		       struct binding *domainbinding, const char *encoding,
+		       struct msgid_hash *hash,
+		       size_t *lengthp, const char **msgidp)
+     internal_function;
+#else
+static char *find_msg (struct loaded_l10nfile *domain_file,
+		       struct binding *domainbinding, struct msgid_hash *hash,
+		       int convert, size_t *lengthp, const char **msgidp)
+     internal_function;
+#endif
 static char *plural_lookup (struct loaded_l10nfile *domain,
 			    unsigned long int n,
-			    const char *translation, size_t translation_len)
+			    const char *translation, size_t translation_len,
+			    const unsigned short *plural_offsets)
      internal_function;
 
 #ifdef IN_LIBGLOCALE
@@ -419,6 +977,8 @@ typedef struct transmem_list
   char data[ZERO];
 } transmem_block_t;
 static struct transmem_list *transmem_list;
+/* Protects transmem_list.  */
+__libc_lock_define_initialized (static, transmem_lock)
 #else
 typedef unsigned char transmem_block_t;
 #endif
@@ -465,75 +1025,323 @@ static int enable_secure;
       else								      \
 	enable_secure = -1;						      \
     }
-#endif
 
-/* Get the function to evaluate the plural expression.  */
-#include "eval-plural.h"
-
-/* Look up MSGID in the DOMAINNAME message catalog for the current
-   CATEGORY locale and, if PLURAL is nonzero, search over string
-   depending on the plural form determined by N.  */
-#ifdef IN_LIBGLOCALE
-char *
-gl_dcigettext (const char *domainname,
-	       const char *msgid1, const char *msgid2,
-	       int plural, unsigned long int n,
-	       int category,
-	       const char *localename, const char *encoding)
-#else
-char *
-DCIGETTEXT (const char *domainname, const char *msgid1, const char *msgid2,
-	    int plural, unsigned long int n, int category)
-#endif
+/* Return nonzero if the program runs SUID or SGID.  Then the environment
+   variables that tune libintl are ignored.  */
+int
+internal_function
+_nl_running_secure (void)
 {
-#ifndef HAVE_ALLOCA
-  struct block_list *block_list = NULL;
-#endif
-  struct loaded_l10nfile *domain;
-  struct binding *binding;
-  const char *categoryname;
-  const char *categoryvalue;
-  const char *dirname;
-  char *xdomainname;
-  char *single_locale;
-  char *retval;
-  size_t retlen;
-  int saved_errno;
-  struct known_translation_t search;
-  struct known_translation_t **foundp = NULL;
-#if defined HAVE_PER_THREAD_LOCALE && !defined IN_LIBGLOCALE
-  const char *localename;
+  DETERMINE_SECURE;
+  return ENABLE_SECURE;
+}
 #endif
-  size_t domainname_len;
 
-  /* If no real MSGID is given return NULL.  */
-  if (msgid1 == NULL)
-    return NULL;
+#if !defined _LIBC && !defined IN_LIBGLOCALE
+/* Nonzero if the lookups are counted per domain, or -1 if the environment
+   variable GETTEXT_DOMAIN_STATS has not been looked at yet.  */
+int _nl_domain_stats_enabled attribute_hidden = -1;
 
-#ifdef _LIBC
-  if (category < 0 || category >= __LC_LAST || category == LC_ALL)
-    /* Bogus.  */
-    return (plural == 0
-	    ? (char *) msgid1
-	    /* Use the Germanic plural rule.  */
-	    : n == 1 ? (char *) msgid1 : (char *) msgid2);
-#endif
+/* The counters of the domains, most recently added first.  They are never
+   freed, so that they can be found without taking a lock.  */
+static struct domain_stats *domain_stats_list;
 
-  /* Preserve the `errno' value.  */
-  saved_errno = errno;
+/* Lock that serializes the additions to domain_stats_list.  */
+gl_lock_define_initialized (static, domain_stats_lock)
 
-#ifdef _LIBC
-  __libc_rwlock_define (extern, __libc_setlocale_lock attribute_hidden)
-  __libc_rwlock_rdlock (__libc_setlocale_lock);
+/* The file to which the counters are appended at exit, or NULL.  */
+static const char *domain_stats_filename;
+
+/* Append the counters of all domains to domain_stats_filename.  */
+static void
+write_domain_stats (void)
+{
+  struct domain_stats *stats;
+  FILE *fp = fopen (domain_stats_filename, "a");
+
+  if (fp == NULL)
+    return;
+
+  for (stats = ATOMIC_LOAD_ACQUIRE (domain_stats_list);
+       stats != NULL;
+       stats = stats->next)
+    fprintf (fp, "domain \"%s\": %lu cache hits, %lu catalog lookups, "
+		 "%lu untranslated, %lu conversions, %lu catalog searches, "
+		 "%lu catalogs loaded, %lu catalogs missing\n",
+	     stats->domainname, stats->cache_hits, stats->catalog_lookups,
+	     stats->untranslated, stats->conversions, stats->catalog_searches,
+	     stats->catalogs_loaded, stats->catalogs_missing);
+
+  fclose (fp);
+}
+
+/* Determine _nl_domain_stats_enabled from the environment variable
+   GETTEXT_DOMAIN_STATS, which names the file to which the counters are
+   appended at exit.  The caller must hold domain_stats_lock.  */
+static void
+init_domain_stats (void)
+{
+  if (_nl_domain_stats_enabled < 0)
+    {
+      const char *filename;
+
+      DETERMINE_SECURE;
+      filename = (ENABLE_SECURE ? NULL : getenv ("GETTEXT_DOMAIN_STATS"));
+      if (filename != NULL && filename[0] != '\0'
+	  && (domain_stats_filename = strdup (filename)) != NULL
+	  && atexit (write_domain_stats) == 0)
+	ATOMIC_STORE_RELAXED (_nl_domain_stats_enabled, 1);
+      else
+	ATOMIC_STORE_RELAXED (_nl_domain_stats_enabled, 0);
+    }
+}
+
+/* Return the counters of the domain whose name is the LEN bytes at
+   DOMAINNAME, or NULL if the lookups are not counted or memory was
+   exhausted.  */
+struct domain_stats *
+internal_function
+_nl_find_domain_stats (const char *domainname, size_t len)
+{
+  struct domain_stats *stats;
+
+  if (ATOMIC_LOAD_RELAXED (_nl_domain_stats_enabled) < 0)
+    {
+      gl_lock_lock (domain_stats_lock);
+      init_domain_stats ();
+      gl_lock_unlock (domain_stats_lock);
+    }
+  if (ATOMIC_LOAD_RELAXED (_nl_domain_stats_enabled) == 0)
+    return NULL;
+
+  for (stats = ATOMIC_LOAD_ACQUIRE (domain_stats_list);
+       stats != NULL;
+       stats = stats->next)
+    if (strncmp (stats->domainname, domainname, len) == 0
+	&& stats->domainname[len] == '\0')
+      return stats;
+
+  gl_lock_lock (domain_stats_lock);
+
+  /* Maybe another thread has added the domain in the meantime.  */
+  for (stats = domain_stats_list; stats != NULL; stats = stats->next)
+    if (strncmp (stats->domainname, domainname, len) == 0
+	&& stats->domainname[len] == '\0')
+      break;
+
+  if (stats == NULL)
+    {
+      stats = (struct domain_stats *)
+	calloc (1, offsetof (struct domain_stats, domainname) + len + 1);
+      if (stats != NULL)
+	{
+	  memcpy (stats->domainname, domainname, len);
+	  stats->domainname[len] = '\0';
+	  stats->next = domain_stats_list;
+	  ATOMIC_STORE_RELEASE (domain_stats_list, stats);
+	}
+    }
+
+  gl_lock_unlock (domain_stats_lock);
+
+  return stats;
+}
+
+/* Return the counters of the domain of the message catalog file FILENAME,
+   which is named DOMAINNAME.mo, or NULL.  */
+struct domain_stats *
+internal_function
+_nl_find_file_domain_stats (const char *filename)
+{
+  const char *base = strrchr (filename, '/');
+  size_t len;
+
+  base = (base != NULL ? base + 1 : filename);
+  len = strlen (base);
+  if (len > 3 && strcmp (base + len - 3, ".mo") == 0)
+    len -= 3;
+
+  return _nl_find_domain_stats (base, len);
+}
+
+/* Start or stop counting the lookups per domain.  */
+void
+libintl_count_domain_stats (int enable)
+{
+  gl_lock_lock (domain_stats_lock);
+  init_domain_stats ();
+  ATOMIC_STORE_RELAXED (_nl_domain_stats_enabled, enable != 0);
+  gl_lock_unlock (domain_stats_lock);
+}
+
+/* Store the counters of up to N domains in STATSP[0], STATSP[1], ...
+   Return the number of domains that have counters.  */
+size_t
+libintl_get_domain_stats (struct libintl_domain_stats *statsp, size_t n)
+{
+  struct domain_stats *stats;
+  size_t count = 0;
+
+  for (stats = ATOMIC_LOAD_ACQUIRE (domain_stats_list);
+       stats != NULL;
+       stats = stats->next)
+    {
+      if (count < n)
+	{
+	  struct libintl_domain_stats *p = &statsp[count];
+
+	  p->domainname = stats->domainname;
+	  p->cache_hits = ATOMIC_LOAD_RELAXED (stats->cache_hits);
+	  p->catalog_lookups = ATOMIC_LOAD_RELAXED (stats->catalog_lookups);
+	  p->untranslated = ATOMIC_LOAD_RELAXED (stats->untranslated);
+	  p->conversions = ATOMIC_LOAD_RELAXED (stats->conversions);
+	  p->catalog_searches = ATOMIC_LOAD_RELAXED (stats->catalog_searches);
+	  p->catalogs_loaded = ATOMIC_LOAD_RELAXED (stats->catalogs_loaded);
+	  p->catalogs_missing =
+	    ATOMIC_LOAD_RELAXED (stats->catalogs_missing);
+	}
+      count++;
+    }
+
+  return count;
+}
+#endif
+
+/* Get the function to evaluate the plural expression.  */
+#include "eval-plural.h"
+
+#ifndef IN_LIBGLOCALE
+/* Return the binding of DOMAINNAME, or NULL if it has none.
+   The caller must hold _nl_state_lock.  */
+static struct binding *
+find_binding (const char *domainname)
+{
+  struct binding *binding;
+
+  for (binding = _nl_domain_bindings; binding != NULL; binding = binding->next)
+    {
+      int compare = strcmp (domainname, binding->domainname);
+      if (compare == 0)
+	/* We found it!  */
+	break;
+      if (compare < 0)
+	{
+	  /* It is not in the list.  */
+	  binding = NULL;
+	  break;
+	}
+    }
+
+  return binding;
+}
+#endif
+
+/* Count MSGID1, a message of DOMAINNAME that is returned untranslated, and
+   log it if the environment variable GETTEXT_LOG_UNTRANSLATED asks for
+   it.  MSGID2 and PLURAL are as for DCIGETTEXT.  */
+static void
+note_untranslated (const char *domainname,
+		   const char *msgid1, const char *msgid2, int plural)
+{
+  DOMAIN_STATS_COUNT (domainname, strlen (domainname), untranslated);
+#ifndef _LIBC
+  DETERMINE_SECURE;
+  if (!ENABLE_SECURE)
+    {
+      extern void _nl_log_untranslated (const char *logfilename,
+					const char *domainname,
+					const char *msgid1, const char *msgid2,
+					int plural);
+      const char *logfilename = getenv ("GETTEXT_LOG_UNTRANSLATED");
+
+      if (logfilename != NULL && logfilename[0] != '\0')
+	_nl_log_untranslated (logfilename, domainname, msgid1, msgid2, plural);
+    }
+#endif
+}
+
+/* Look up MSGID in the DOMAINNAME message catalog for the current
+   CATEGORY locale and, if PLURAL is nonzero, search over string
+   depending on the plural form determined by N.  */
+#ifdef IN_LIBGLOCALE
+char *
+gl_dcigettext (const char *domainname,
+	       const char *msgid1, const char *msgid2,
+	       int plural, unsigned long int n,
+	       int category,
+	       const char *localename, const char *encoding)
+#else
+char *
+DCIGETTEXT (const char *domainname, const char *msgid1, const char *msgid2,
+	    int plural, unsigned long int n, int category)
+#endif
+{
+#ifndef HAVE_ALLOCA
+  struct block_list *block_list = NULL;
+#endif
+  struct loaded_l10nfile *domain;
+  struct binding *binding;
+  const char * const *layers;
+  size_t nlayers;
+  size_t layer;
+  struct binding **layer_bindings;
+  const char **layer_dirnames;
+  char **layer_xdomainnames;
+  const char *categoryname;
+  const char *categoryvalue;
+  const char *dirname;
+  char *xdomainname;
+  char *single_locale;
+  char *layer_locale;
+  char *retval;
+  size_t retlen;
+  const char *found_msgid;
+  int saved_errno;
+  struct msgid_hash msgid_hash;
+#ifdef HAVE_PER_THREAD_LOCALE
+  struct known_translation_key search;
+  struct known_translation_t entry;
+#endif
+#if defined HAVE_PER_THREAD_LOCALE && !defined IN_LIBGLOCALE
+  const char *localename;
+#endif
+
+  /* If no real MSGID is given return NULL.  */
+  if (msgid1 == NULL)
+    return NULL;
+
+  msgid_hash_init (&msgid_hash, msgid1);
+
+#ifdef _LIBC
+  if (category < 0 || category >= __LC_LAST || category == LC_ALL)
+    /* Bogus.  */
+    return (plural == 0
+	    ? (char *) msgid1
+	    /* Use the Germanic plural rule.  */
+	    : n == 1 ? (char *) msgid1 : (char *) msgid2);
+#endif
+
+  /* Preserve the `errno' value.  */
+  saved_errno = errno;
+
+#ifdef _LIBC
+  __libc_rwlock_define (extern, __libc_setlocale_lock attribute_hidden)
+  __libc_rwlock_rdlock (__libc_setlocale_lock);
 #endif
 
+  /* With HAVE_LOCKFREE_READERS, a lookup among the known translations
+     doesn't need _nl_state_lock: _nl_current_default_domain is published
+     with release semantics and its old values are never freed, and the
+     table of known translations can be read without a lock.  */
+#ifndef HAVE_LOCKFREE_READERS
   gl_rwlock_rdlock (_nl_state_lock);
+#endif
 
   /* If DOMAINNAME is NULL, we are interested in the default domain.  If
      CATEGORY is not LC_MESSAGES this might not make much sense but the
      definition left this undefined.  */
   if (domainname == NULL)
-    domainname = _nl_current_default_domain;
+    domainname = ATOMIC_LOAD_ACQUIRE (_nl_current_default_domain);
 
   /* OS/2 specific: backward compatibility with older libintl versions  */
 #ifdef LC_MESSAGES_COMPAT
@@ -543,10 +1351,6 @@ DCIGETTEXT (const char *domainname, const char *msgid1, const char *msgid2,
 
   /* Try to find the translation among those which we found at
      some time.  */
-  search.domain = NULL;
-  search.msgid.ptr = msgid1;
-  search.domainname = domainname;
-  search.category = category;
 #ifdef HAVE_PER_THREAD_LOCALE
 # ifndef IN_LIBGLOCALE
 #  ifdef _LIBC
@@ -559,29 +1363,31 @@ DCIGETTEXT (const char *domainname, const char *msgid1, const char *msgid2,
     localename = "";
 #  endif
 # endif
+  search.msgid = msgid1;
+  search.domainname = domainname;
+  search.category = category;
   search.localename = localename;
 # ifdef IN_LIBGLOCALE
   search.encoding = encoding;
 # endif
+  search.hash = known_translation_hash (msgid_hash_murmur3 (&msgid_hash),
+					known_translation_context_hash (&search));
 
-  /* Since tfind/tsearch manage a balanced tree, concurrent tfind and
-     tsearch calls can be fatal.  */
-  gl_rwlock_rdlock (tree_lock);
-
-  foundp = (struct known_translation_t **) tfind (&search, &root, transcmp);
-
-  gl_rwlock_unlock (tree_lock);
-
-  if (foundp != NULL && (*foundp)->counter == _nl_msg_cat_cntr)
+  if (known_translation_lookup (&search, &entry))
     {
+      DOMAIN_STATS_COUNT (domainname, strlen (domainname), cache_hits);
+
       /* Now deal with plural.  */
       if (plural)
-	retval = plural_lookup ((*foundp)->domain, n, (*foundp)->translation,
-				(*foundp)->translation_length);
+	retval = plural_lookup (entry.value.domain, n, entry.value.translation,
+				entry.value.translation_length,
+				entry.value.plural_offsets);
       else
-	retval = (char *) (*foundp)->translation;
+	retval = (char *) entry.value.translation;
 
+# ifndef HAVE_LOCKFREE_READERS
       gl_rwlock_unlock (_nl_state_lock);
+# endif
 # ifdef _LIBC
       __libc_rwlock_unlock (__libc_setlocale_lock);
 # endif
@@ -590,6 +1396,12 @@ DCIGETTEXT (const char *domainname, const char *msgid1, const char *msgid2,
     }
 #endif
 
+#ifdef HAVE_LOCKFREE_READERS
+  gl_rwlock_rdlock (_nl_state_lock);
+#endif
+
+  DOMAIN_STATS_COUNT (domainname, strlen (domainname), catalog_lookups);
+
   /* See whether this is a SUID binary or not.  */
   DETERMINE_SECURE;
 
@@ -598,276 +1410,1751 @@ DCIGETTEXT (const char *domainname, const char *msgid1, const char *msgid2,
   /* We can use a trivial binding, since _nl_find_msg will ignore it anyway,
      and _nl_load_domain and _nl_find_domain just pass it through.  */
   binding = NULL;
-  dirname = bindtextdomain (domainname, NULL);
+  layers = NULL;
+  nlayers = 1;
 #else
-  for (binding = _nl_domain_bindings; binding != NULL; binding = binding->next)
+  binding = find_binding (domainname);
+
+  /* If DOMAINNAME is composed of layers, the message is looked up in the
+     layers instead, in order.  */
+  if (binding != NULL && binding->layers != NULL)
     {
-      int compare = strcmp (domainname, binding->domainname);
-      if (compare == 0)
-	/* We found it!  */
-	break;
-      if (compare < 0)
-	{
-	  /* It is not in the list.  */
-	  binding = NULL;
-	  break;
-	}
+      layers = (const char * const *) binding->layers;
+      for (nlayers = 0; layers[nlayers] != NULL; nlayers++)
+	;
     }
-
-  if (binding == NULL)
-    dirname = _nl_default_dirname;
   else
     {
-      dirname = binding->dirname;
+      layers = NULL;
+      nlayers = 1;
+    }
 #endif
-      if (!IS_ABSOLUTE_PATH (dirname))
-	{
-	  /* We have a relative path.  Make it absolute now.  */
-	  size_t dirname_len = strlen (dirname) + 1;
-	  size_t path_max;
-	  char *resolved_dirname;
-	  char *ret;
 
-	  path_max = (unsigned int) PATH_MAX;
-	  path_max += 2;		/* The getcwd docs say to do this.  */
+  /* Now determine the symbolic name of CATEGORY and its value.  */
+#ifndef CATEGORYNAME_INITIALIZED
+  categoryname = category_to_name (category);
+#endif
+#ifdef IN_LIBGLOCALE
+  categoryvalue = guess_category_value (category, categoryname, localename);
+#else
+  categoryvalue = guess_category_value (category, categoryname);
+#endif
+
+  /* Determine the binding, the directory and the file name of each
+     layer.  */
+  layer_bindings =
+    (struct binding **) alloca (nlayers * sizeof (struct binding *));
+  ADD_BLOCK (block_list, layer_bindings);
+  layer_dirnames = (const char **) alloca (nlayers * sizeof (const char *));
+  ADD_BLOCK (block_list, layer_dirnames);
+  layer_xdomainnames = (char **) alloca (nlayers * sizeof (char *));
+  ADD_BLOCK (block_list, layer_xdomainnames);
+
+  for (layer = 0; layer < nlayers; layer++)
+    {
+      const char *layer_domainname;
+      size_t domainname_len;
+
+      if (layers != NULL)
+	{
+	  layer_domainname = layers[layer];
+	  binding = find_binding (layer_domainname);
+	}
+      else
+	layer_domainname = domainname;
 
-	  for (;;)
+#ifdef IN_LIBGLOCALE
+      dirname = bindtextdomain (layer_domainname, NULL);
+#else
+      if (binding == NULL)
+	dirname = _nl_default_dirname;
+      else
+	{
+	  dirname = binding->dirname;
+#endif
+	  if (!IS_ABSOLUTE_PATH (dirname))
 	    {
-	      resolved_dirname = (char *) alloca (path_max + dirname_len);
-	      ADD_BLOCK (block_list, tmp_dirname);
+	      /* We have a relative path.  Make it absolute now.  */
+	      size_t dirname_len = strlen (dirname) + 1;
+	      size_t path_max;
+	      char *resolved_dirname;
+	      char *ret;
 
-	      __set_errno (0);
-	      ret = getcwd (resolved_dirname, path_max);
-	      if (ret != NULL || errno != ERANGE)
-		break;
+	      path_max = (unsigned int) PATH_MAX;
+	      path_max += 2;		/* The getcwd docs say to do this.  */
 
-	      path_max += path_max / 2;
-	      path_max += PATH_INCR;
-	    }
+	      for (;;)
+		{
+		  resolved_dirname = (char *) alloca (path_max + dirname_len);
+		  ADD_BLOCK (block_list, tmp_dirname);
 
-	  if (ret == NULL)
-	    /* We cannot get the current working directory.  Don't signal an
-	       error but simply return the default string.  */
-	    goto return_untranslated;
+		  __set_errno (0);
+		  ret = getcwd (resolved_dirname, path_max);
+		  if (ret != NULL || errno != ERANGE)
+		    break;
 
-	  stpcpy (stpcpy (strchr (resolved_dirname, '\0'), "/"), dirname);
-	  dirname = resolved_dirname;
-	}
+		  path_max += path_max / 2;
+		  path_max += PATH_INCR;
+		}
+
+	      if (ret == NULL)
+		/* We cannot get the current working directory.  Don't
+		   signal an error but simply return the default string.  */
+		goto return_untranslated;
+
+	      stpcpy (stpcpy (strchr (resolved_dirname, '\0'), "/"), dirname);
+	      dirname = resolved_dirname;
+	    }
 #ifndef IN_LIBGLOCALE
+	}
+#endif
+
+      domainname_len = strlen (layer_domainname);
+      xdomainname = (char *) alloca (strlen (categoryname)
+				     + domainname_len + 5);
+      ADD_BLOCK (block_list, xdomainname);
+
+      stpcpy ((char *) mempcpy (stpcpy (stpcpy (xdomainname, categoryname),
+					"/"),
+				layer_domainname, domainname_len),
+	      ".mo");
+
+      layer_bindings[layer] = binding;
+      layer_dirnames[layer] = dirname;
+      layer_xdomainnames[layer] = xdomainname;
     }
+
+  /* Creating working area.  _nl_find_domain may modify the locale name it
+     is given, therefore each layer after the first gets a copy.  */
+  single_locale = (char *) alloca (strlen (categoryvalue) + 1);
+  ADD_BLOCK (block_list, single_locale);
+  layer_locale =
+    (nlayers > 1 ? (char *) alloca (strlen (categoryvalue) + 1) : NULL);
+  ADD_BLOCK (block_list, layer_locale);
+
+
+  /* Search for the given string.  This is a loop because we perhaps
+     got an ordered list of languages to consider for the translation.  */
+  while (1)
+    {
+      /* Make CATEGORYVALUE point to the next element of the list.  */
+      while (categoryvalue[0] != '\0' && categoryvalue[0] == ':')
+	++categoryvalue;
+      if (categoryvalue[0] == '\0')
+	{
+	  /* The whole contents of CATEGORYVALUE has been searched but
+	     no valid entry has been found.  We solve this situation
+	     by implicitly appending a "C" entry, i.e. no translation
+	     will take place.  */
+	  single_locale[0] = 'C';
+	  single_locale[1] = '\0';
+	}
+      else
+	{
+	  char *cp = single_locale;
+	  while (categoryvalue[0] != '\0' && categoryvalue[0] != ':')
+	    *cp++ = *categoryvalue++;
+	  *cp = '\0';
+
+	  /* When this is a SUID binary we must not allow accessing files
+	     outside the dedicated directories.  */
+	  if (ENABLE_SECURE && IS_PATH_WITH_DIR (single_locale))
+	    /* Ingore this entry.  */
+	    continue;
+	}
+
+      /* If the current locale value is C (or POSIX) we don't load a
+	 domain.  Return the MSGID.  */
+      if (strcmp (single_locale, "C") == 0
+	  || strcmp (single_locale, "POSIX") == 0)
+	break;
+
+      /* Find structure describing the message catalog matching the
+	 DOMAINNAME and CATEGORY, in each layer.  The first layer that
+	 has a translation wins.  */
+      retval = NULL;
+      for (layer = 0; layer < nlayers; layer++)
+	{
+	  binding = layer_bindings[layer];
+	  domain = _nl_find_domain (layer_dirnames[layer],
+				    (layer_locale != NULL
+				     ? strcpy (layer_locale, single_locale)
+				     : single_locale),
+				    layer_xdomainnames[layer], binding);
+
+	  if (domain != NULL)
+	    {
+#if defined IN_LIBGLOCALE
+	      retval = find_msg (domain, binding, encoding, &msgid_hash,
+				 &retlen, &found_msgid);
+#else
+	      retval = find_msg (domain, binding, &msgid_hash, 1, &retlen,
+				 &found_msgid);
 #endif
 
-  /* Now determine the symbolic name of CATEGORY and its value.  */
-#ifndef CATEGORYNAME_INITIALIZED
-  categoryname = category_to_name (category);
+	      if (retval == NULL)
+		{
+		  int cnt;
+
+		  for (cnt = 0; domain->successor[cnt] != NULL; ++cnt)
+		    {
+#if defined IN_LIBGLOCALE
+		      retval = find_msg (domain->successor[cnt], binding,
+					 encoding, &msgid_hash, &retlen,
+					 &found_msgid);
+#else
+		      retval = find_msg (domain->successor[cnt], binding,
+					 &msgid_hash, 1, &retlen,
+					 &found_msgid);
 #endif
-#ifdef IN_LIBGLOCALE
-  categoryvalue = guess_category_value (category, categoryname, localename);
+
+		      if (retval != NULL)
+			{
+			  domain = domain->successor[cnt];
+			  break;
+			}
+		    }
+		}
+
+	      if (retval != NULL)
+		break;
+	    }
+	}
+
+      /* Returning -1 means that some resource problem exists
+	 (likely memory) and that the strings could not be
+	 converted.  Return the original strings.  */
+      if (__builtin_expect (retval == (char *) -1, 0))
+	break;
+
+      if (retval != NULL)
+	{
+	  /* Found the translation of MSGID1 in domain DOMAIN:
+	     starting at RETVAL, RETLEN bytes.  */
+	  FREE_BLOCKS (block_list);
+#ifdef HAVE_PER_THREAD_LOCALE
+	  known_translation_remember (&search, found_msgid, domain,
+				      retval, retlen);
+#endif
+
+	  __set_errno (saved_errno);
+
+	  /* Now deal with plural.  */
+	  if (plural)
+	    retval = plural_lookup (domain, n, retval, retlen, NULL);
+
+	  gl_rwlock_unlock (_nl_state_lock);
+#ifdef _LIBC
+	  __libc_rwlock_unlock (__libc_setlocale_lock);
+#endif
+	  return retval;
+	}
+    }
+
+ return_untranslated:
+  /* Return the untranslated MSGID.  */
+  FREE_BLOCKS (block_list);
+  gl_rwlock_unlock (_nl_state_lock);
+#ifdef _LIBC
+  __libc_rwlock_unlock (__libc_setlocale_lock);
+#endif
+  note_untranslated (domainname, msgid1, msgid2, plural);
+  __set_errno (saved_errno);
+  return (plural == 0
+	  ? (char *) msgid1
+	  /* Use the Germanic plural rule.  */
+	  : n == 1 ? (char *) msgid1 : (char *) msgid2);
+}
+
+
+#if !defined _LIBC && !defined IN_LIBGLOCALE
+/* Return DIRNAME as an absolute file name, in freshly allocated memory.
+   Return NULL if memory was exhausted or the current directory cannot be
+   determined.  */
+static char *
+absolute_dirname (const char *dirname)
+{
+  size_t dirname_len = strlen (dirname) + 1;
+  size_t path_max;
+  char *resolved_dirname;
+
+  if (IS_ABSOLUTE_PATH (dirname))
+    {
+      resolved_dirname = (char *) malloc (dirname_len);
+      if (resolved_dirname != NULL)
+	memcpy (resolved_dirname, dirname, dirname_len);
+      return resolved_dirname;
+    }
+
+  path_max = (unsigned int) PATH_MAX;
+  path_max += 2;		/* The getcwd docs say to do this.  */
+
+  for (;;)
+    {
+      resolved_dirname = (char *) malloc (path_max + dirname_len);
+      if (resolved_dirname == NULL)
+	return NULL;
+
+      __set_errno (0);
+      if (getcwd (resolved_dirname, path_max) != NULL)
+	break;
+      free (resolved_dirname);
+      if (errno != ERANGE)
+	return NULL;
+
+      path_max += path_max / 2;
+      path_max += PATH_INCR;
+    }
+
+  stpcpy (stpcpy (strchr (resolved_dirname, '\0'), "/"), dirname);
+  return resolved_dirname;
+}
+
+/* Load the message catalog XDOMAINNAME in DIRNAME for each locale of the
+   colon-separated list LANGUAGES, and its fallbacks, as DCIGETTEXT would,
+   and prepare them for lookups.  Return the number of catalogs found, or
+   -1 if memory was exhausted.  The caller must hold _nl_state_lock.  */
+static int
+preload_catalogs (const char *dirname, const char *xdomainname,
+		  struct binding *binding, const char *languages)
+{
+  int count = 0;
+
+  for (;;)
+    {
+      const char *end;
+      char *single_locale;
+      struct loaded_l10nfile *domain;
+
+      while (languages[0] == ':')
+	++languages;
+      if (languages[0] == '\0')
+	break;
+
+      end = strchr (languages, ':');
+      if (end == NULL)
+	end = languages + strlen (languages);
+      single_locale = (char *) malloc (end - languages + 1);
+      if (single_locale == NULL)
+	return -1;
+      memcpy (single_locale, languages, end - languages);
+      single_locale[end - languages] = '\0';
+      languages = end;
+
+      /* Skip the entries that DCIGETTEXT would skip.  */
+      if (!(ENABLE_SECURE && IS_PATH_WITH_DIR (single_locale))
+	  && strcmp (single_locale, "C") != 0
+	  && strcmp (single_locale, "POSIX") != 0)
+	{
+	  domain = _nl_find_domain (dirname, single_locale, xdomainname,
+				    binding);
+	  if (domain != NULL)
+	    {
+	      /* DCIGETTEXT looks up a message in the successors too, when
+		 it is not found in DOMAIN: prepare all of them.  */
+	      struct loaded_l10nfile *found = domain;
+	      int cnt = 0;
+
+	      do
+		{
+		  if (found->decided <= 0)
+		    _nl_load_domain (found, binding);
+		  if (found->data != NULL)
+		    {
+		      size_t len;
+
+		      _nl_advise_domain (found);
+		      /* Set up the conversion to the output charset now,
+			 rather than during the first lookup.  */
+		      _nl_find_msg (found, binding, "", 1, &len, NULL);
+		      count++;
+		    }
+		  found = domain->successor[cnt++];
+		}
+	      while (found != NULL);
+	    }
+	}
+
+      free (single_locale);
+    }
+
+  return count;
+}
+
+/* Load the message catalogs of DOMAINNAME for the given LOCALES ahead of
+   the first lookup.  */
+int
+libintl_textdomain_preload (const char *domainname, const char *dirname,
+			    const char * const *locales)
+{
+  struct binding *binding;
+  const char * const *layers;
+  size_t nlayers;
+  size_t layer;
+  const char *categoryname;
+  const char *categoryvalue;
+  int count;
+
+  if (domainname == NULL)
+    domainname = textdomain (NULL);
+  if (dirname != NULL && bindtextdomain (domainname, dirname) == NULL)
+    return -1;
+
+  gl_rwlock_rdlock (_nl_state_lock);
+
+  DETERMINE_SECURE;
+
+  categoryname = category_to_name (LC_MESSAGES);
+  categoryvalue =
+    (locales == NULL ? guess_category_value (LC_MESSAGES, categoryname)
+     : NULL);
+
+  binding = find_binding (domainname);
+  if (binding != NULL && binding->layers != NULL)
+    {
+      layers = (const char * const *) binding->layers;
+      for (nlayers = 0; layers[nlayers] != NULL; nlayers++)
+	;
+    }
+  else
+    {
+      layers = &domainname;
+      nlayers = 1;
+    }
+
+  count = 0;
+  for (layer = 0; layer < nlayers && count >= 0; layer++)
+    {
+      struct binding *layer_binding = find_binding (layers[layer]);
+      char *layer_dirname;
+      char *xdomainname;
+
+      layer_dirname =
+	absolute_dirname (layer_binding != NULL
+			  ? layer_binding->dirname : _nl_default_dirname);
+      xdomainname = (char *) malloc (strlen (categoryname)
+				     + strlen (layers[layer]) + 5);
+      if (layer_dirname != NULL && xdomainname != NULL)
+	{
+	  stpcpy (stpcpy (stpcpy (stpcpy (xdomainname, categoryname), "/"),
+			  layers[layer]),
+		  ".mo");
+
+	  if (locales == NULL)
+	    {
+	      int n = preload_catalogs (layer_dirname, xdomainname,
+					layer_binding, categoryvalue);
+	      count = (n < 0 ? -1 : count + n);
+	    }
+	  else
+	    {
+	      size_t i;
+
+	      for (i = 0; locales[i] != NULL && count >= 0; i++)
+		{
+		  int n = preload_catalogs (layer_dirname, xdomainname,
+					    layer_binding, locales[i]);
+		  count = (n < 0 ? -1 : count + n);
+		}
+	    }
+	}
+      else
+	count = -1;
+
+      free (xdomainname);
+      free (layer_dirname);
+    }
+
+  gl_rwlock_unlock (_nl_state_lock);
+
+  return count;
+}
+
+#ifdef HAVE_PER_THREAD_LOCALE
+/* Return nonzero if the messages of DOMAINNAME are looked up in the message
+   catalogs of RELOADED.  The caller must hold _nl_state_lock.  */
+static int
+domain_uses (const char *domainname, const char *reloaded)
+{
+  struct binding *binding;
+
+  if (strcmp (domainname, reloaded) == 0)
+    return 1;
+
+  binding = find_binding (domainname);
+  if (binding != NULL && binding->layers != NULL)
+    {
+      char **layer;
+
+      for (layer = binding->layers; *layer != NULL; layer++)
+	if (strcmp (*layer, reloaded) == 0)
+	  return 1;
+    }
+
+  return 0;
+}
+
+/* Remove the known translations that were looked up in the message
+   catalogs of DOMAINNAME.  The caller must hold _nl_state_lock and
+   known_translations_lock for writing.  */
+static void
+known_translation_forget (const char *domainname)
+{
+  struct known_translation_table *table = known_translations;
+  struct known_translation_t empty;
+  size_t i;
+
+  if (table == NULL)
+    return;
+
+  memset (&empty, '\0', sizeof (empty));
+  for (i = 0; i < table->size; i++)
+    if (table->slots[i].msgid != NULL
+	&& domain_uses (table->slots[i].domainname, domainname))
+      {
+	known_translation_write (&table->slots[i], &empty);
+	table->filled--;
+      }
+}
+#endif
+
+/* Read the loaded message catalogs of DOMAINNAME again whose files have
+   changed, and forget the translations that were looked up in them.  The
+   translations of the other domains remain known.  */
+int
+libintl_reload_domain (const char *domainname)
+{
+  int count;
+
+  if (domainname == NULL)
+    domainname = textdomain (NULL);
+
+  /* Holding _nl_state_lock for writing keeps out the lookups that could
+     add a translation from an old catalog to the known translations after
+     they have been forgotten.  The lookups among the known translations
+     continue meanwhile, and see either the old or the new translation.  */
+  gl_rwlock_wrlock (_nl_state_lock);
+
+  count = _nl_reload_domains (domainname, find_binding (domainname));
+
+#ifdef HAVE_PER_THREAD_LOCALE
+  if (count > 0)
+    {
+      gl_rwlock_wrlock (known_translations_lock);
+      known_translation_forget (domainname);
+      gl_rwlock_unlock (known_translations_lock);
+    }
+#endif
+
+  gl_rwlock_unlock (_nl_state_lock);
+
+  return count;
+}
+
+
+/* A message catalog consulted by a translation context.  */
+struct context_catalog
+{
+  struct loaded_l10nfile *domain;
+  /* A copy of the binding of its layer, or NULL.  */
+  struct binding *binding;
+};
+
+/* The message catalogs of a domain, as resolved for a translation
+   context.  */
+struct context_domain
+{
+  struct context_domain *next;
+  /* The value of _nl_msg_cat_cntr when the catalogs were resolved.  */
+  int counter;
+  /* The catalogs to consult, in order.  */
+  struct context_catalog *catalogs;
+  size_t ncatalogs;
+  /* Copies of the bindings of the layers of the domain.  gettext() may
+     free the original ones at any time.  */
+  struct binding **bindings;
+  size_t nbindings;
+  char domainname[ZERO];
+};
+
+struct libintl_context
+{
+  /* The next context in the list of those of libintl_dcgettext_batch.  */
+  struct libintl_context *next;
+  /* Protects the list of domains.  */
+  gl_rwlock_define (, lock)
+  /* The colon-separated list of locale names.  */
+  char *locales;
+  /* The category whose message catalogs are looked up.  */
+  int category;
+  struct context_domain *domains;
+};
+
+/* Return a copy of the parts of BINDING, the binding of DOMAINNAME, that
+   _nl_find_msg uses, or NULL if they are the defaults.  If CODESET is not
+   NULL, it replaces the codeset of BINDING.  Set *OKP to 0 if memory was
+   exhausted.  */
+static struct binding *
+copy_binding (const char *domainname, const struct binding *binding,
+	      const char *codeset, int *okp)
+{
+  struct binding *copy;
+  size_t len;
+
+  if (codeset == NULL && binding != NULL)
+    codeset = binding->codeset;
+  if (codeset == NULL)
+    return NULL;
+
+  len = strlen (domainname) + 1;
+  copy = (struct binding *) malloc (offsetof (struct binding, domainname)
+				    + len);
+  if (copy == NULL)
+    {
+      *okp = 0;
+      return NULL;
+    }
+  copy->next = NULL;
+  copy->dirname = NULL;
+  copy->codeset = strdup (codeset);
+  copy->layers = NULL;
+  memcpy (copy->domainname, domainname, len);
+  if (copy->codeset == NULL)
+    {
+      free (copy);
+      *okp = 0;
+      return NULL;
+    }
+  return copy;
+}
+
+static void
+free_bindings (struct binding **bindings, size_t nbindings)
+{
+  size_t i;
+
+  for (i = 0; i < nbindings; i++)
+    if (bindings[i] != NULL)
+      {
+	free (bindings[i]->codeset);
+	free (bindings[i]);
+      }
+  free (bindings);
+}
+
+/* Append DOMAIN, if it has data, to the NCATALOGS catalogs at *CATALOGSP.
+   DOMAIN is loaded first if that was not yet tried, through DOMAINBINDING.
+   Return 0 if memory was exhausted.  */
+static int
+add_context_catalog (struct context_catalog **catalogsp, size_t *ncatalogsp,
+		     size_t *allocatedp, struct loaded_l10nfile *domain,
+		     struct binding *domainbinding, struct binding *binding)
+{
+  /* _nl_find_domain loads the successors of DOMAIN only up to the first
+     one that has data, but the catalogs behind it are consulted too.  */
+  if (domain->decided <= 0)
+    _nl_load_domain (domain, domainbinding);
+  if (domain->data == NULL)
+    return 1;
+
+  if (*ncatalogsp == *allocatedp)
+    {
+      size_t new_allocated = 2 * *allocatedp + 4;
+      struct context_catalog *new_catalogs =
+	(struct context_catalog *)
+	realloc (*catalogsp, new_allocated * sizeof (struct context_catalog));
+
+      if (new_catalogs == NULL)
+	return 0;
+      *catalogsp = new_catalogs;
+      *allocatedp = new_allocated;
+    }
+  (*catalogsp)[*ncatalogsp].domain = domain;
+  (*catalogsp)[*ncatalogsp].binding = binding;
+  (*ncatalogsp)++;
+  return 1;
+}
+
+/* Determine the message catalogs that DCIGETTEXT would consult for
+   DOMAINNAME, CATEGORY and the locales LOCALES, in order, and store them in
+   CD.  If CODESET is not NULL, it replaces the codesets of the bindings.
+   Return 0 if memory was exhausted.  The caller must hold
+   _nl_state_lock.  */
+static int
+resolve_context_domain (const char *locales, const char *domainname,
+			int category, const char *codeset,
+			struct context_domain *cd)
+{
+  struct binding *binding;
+  const char * const *layers;
+  size_t nlayers;
+  size_t layer;
+  const char *categoryname;
+  char **dirnames;
+  char **xdomainnames;
+  struct binding **bindings;
+  struct context_catalog *catalogs = NULL;
+  size_t ncatalogs = 0;
+  size_t allocated = 0;
+  int ok = 1;
+
+  DETERMINE_SECURE;
+
+  categoryname = category_to_name (category);
+
+  binding = find_binding (domainname);
+  if (binding != NULL && binding->layers != NULL)
+    {
+      layers = (const char * const *) binding->layers;
+      for (nlayers = 0; layers[nlayers] != NULL; nlayers++)
+	;
+    }
+  else
+    {
+      layers = &domainname;
+      nlayers = 1;
+    }
+
+  dirnames = (char **) calloc (nlayers, sizeof (char *));
+  xdomainnames = (char **) calloc (nlayers, sizeof (char *));
+  bindings = (struct binding **) calloc (nlayers, sizeof (struct binding *));
+  if (dirnames == NULL || xdomainnames == NULL || bindings == NULL)
+    ok = 0;
+
+  /* Determine the directory and the file name of each layer.  */
+  for (layer = 0; layer < nlayers && ok; layer++)
+    {
+      struct binding *layer_binding = find_binding (layers[layer]);
+
+      dirnames[layer] =
+	absolute_dirname (layer_binding != NULL
+			  ? layer_binding->dirname : _nl_default_dirname);
+      xdomainnames[layer] = (char *) malloc (strlen (categoryname)
+					     + strlen (layers[layer]) + 5);
+      bindings[layer] =
+	copy_binding (layers[layer], layer_binding, codeset, &ok);
+      if (dirnames[layer] == NULL || xdomainnames[layer] == NULL)
+	ok = 0;
+      else
+	stpcpy (stpcpy (stpcpy (stpcpy (xdomainnames[layer], categoryname),
+				"/"),
+			layers[layer]),
+		".mo");
+    }
+
+  /* Find the catalogs of each locale, as DCIGETTEXT does.  */
+  while (ok)
+    {
+      const char *end;
+      size_t len;
+
+      while (locales[0] == ':')
+	++locales;
+      if (locales[0] == '\0')
+	break;
+
+      end = strchr (locales, ':');
+      if (end == NULL)
+	end = locales + strlen (locales);
+      len = end - locales;
+
+      if (len == 1 && locales[0] == 'C')
+	break;
+      if (len == 5 && memcmp (locales, "POSIX", 5) == 0)
+	break;
+
+      for (layer = 0; layer < nlayers && ok; layer++)
+	{
+	  /* _nl_find_domain may modify the locale name it is given.  */
+	  char *single_locale = (char *) malloc (len + 1);
+	  struct loaded_l10nfile *domain;
+
+	  if (single_locale == NULL)
+	    {
+	      ok = 0;
+	      break;
+	    }
+	  memcpy (single_locale, locales, len);
+	  single_locale[len] = '\0';
+
+	  /* When this is a SUID binary we must not allow accessing files
+	     outside the dedicated directories.  */
+	  if (!(ENABLE_SECURE && IS_PATH_WITH_DIR (single_locale)))
+	    {
+	      struct binding *domainbinding = find_binding (layers[layer]);
+
+	      domain = _nl_find_domain (dirnames[layer], single_locale,
+					xdomainnames[layer], domainbinding);
+	      if (domain != NULL)
+		{
+		  int cnt;
+
+		  ok = add_context_catalog (&catalogs, &ncatalogs, &allocated,
+					    domain, domainbinding,
+					    bindings[layer]);
+		  for (cnt = 0; ok && domain->successor[cnt] != NULL; ++cnt)
+		    ok = add_context_catalog (&catalogs, &ncatalogs,
+					      &allocated,
+					      domain->successor[cnt],
+					      domainbinding, bindings[layer]);
+		}
+	    }
+
+	  free (single_locale);
+	}
+
+      locales = end;
+    }
+
+  if (dirnames != NULL)
+    for (layer = 0; layer < nlayers; layer++)
+      free (dirnames[layer]);
+  free (dirnames);
+  if (xdomainnames != NULL)
+    for (layer = 0; layer < nlayers; layer++)
+      free (xdomainnames[layer]);
+  free (xdomainnames);
+
+  if (!ok)
+    {
+      if (bindings != NULL)
+	free_bindings (bindings, nlayers);
+      free (catalogs);
+      return 0;
+    }
+
+  cd->catalogs = catalogs;
+  cd->ncatalogs = ncatalogs;
+  cd->bindings = bindings;
+  cd->nbindings = nlayers;
+  return 1;
+}
+
+/* Resolve the message catalogs of DOMAINNAME for CONTEXT again.  Return 0
+   if memory was exhausted.  */
+static int
+update_context_domain (struct libintl_context *context, const char *domainname)
+{
+  struct context_domain resolved;
+  struct context_domain *cd;
+  int ok;
+
+  /* Read the counter first, so that changes made while the catalogs are
+     being resolved cause them to be resolved again.  */
+  resolved.counter = ATOMIC_LOAD_RELAXED (_nl_msg_cat_cntr);
+
+  gl_rwlock_rdlock (_nl_state_lock);
+  ok = resolve_context_domain (context->locales, domainname,
+			       context->category, NULL, &resolved);
+  gl_rwlock_unlock (_nl_state_lock);
+  if (!ok)
+    return 0;
+
+  gl_rwlock_wrlock (context->lock);
+
+  for (cd = context->domains; cd != NULL; cd = cd->next)
+    if (strcmp (cd->domainname, domainname) == 0)
+      break;
+
+  if (cd == NULL)
+    {
+      size_t len = strlen (domainname) + 1;
+
+      cd = (struct context_domain *)
+	malloc (offsetof (struct context_domain, domainname) + len);
+      if (cd == NULL)
+	{
+	  gl_rwlock_unlock (context->lock);
+	  free_bindings (resolved.bindings, resolved.nbindings);
+	  free (resolved.catalogs);
+	  return 0;
+	}
+      memcpy (cd->domainname, domainname, len);
+      cd->next = context->domains;
+      context->domains = cd;
+    }
+  else
+    {
+      free_bindings (cd->bindings, cd->nbindings);
+      free (cd->catalogs);
+    }
+
+  cd->counter = resolved.counter;
+  cd->catalogs = resolved.catalogs;
+  cd->ncatalogs = resolved.ncatalogs;
+  cd->bindings = resolved.bindings;
+  cd->nbindings = resolved.nbindings;
+
+  gl_rwlock_unlock (context->lock);
+
+  return 1;
+}
+
+/* Find the message catalogs of DOMAINNAME for CONTEXT, resolving them if
+   they are not known yet or the bindings have changed since, and return
+   them with CONTEXT->lock held for reading.  Return NULL, without the lock,
+   if memory was exhausted.  */
+static struct context_domain *
+lock_context_domain (struct libintl_context *context, const char *domainname)
+{
+  int resolved = 0;
+
+  for (;;)
+    {
+      struct context_domain *cd;
+
+      gl_rwlock_rdlock (context->lock);
+
+      for (cd = context->domains; cd != NULL; cd = cd->next)
+	if (strcmp (cd->domainname, domainname) == 0)
+	  break;
+
+      /* The catalogs are used until a binding or the default domain
+	 changes.  Catalogs that were just resolved are used in any case.  */
+      if (cd != NULL
+	  && (resolved
+	      || cd->counter == ATOMIC_LOAD_RELAXED (_nl_msg_cat_cntr)))
+	return cd;
+
+      gl_rwlock_unlock (context->lock);
+
+      if (resolved || !update_context_domain (context, domainname))
+	return NULL;
+      resolved = 1;
+    }
+}
+
+/* Look up the message of HASH in the NCATALOGS catalogs at CATALOGS, in
+   order.  Return its translation, with all plural forms, and store its
+   length in *LENGTHP, the catalog in *DOMAINP and the msgid in that catalog
+   in *MSGIDP.  Return NULL if it is not found.  */
+static char *
+lookup_in_catalogs (const struct context_catalog *catalogs, size_t ncatalogs,
+		    struct msgid_hash *hash, struct loaded_l10nfile **domainp,
+		    size_t *lengthp, const char **msgidp)
+{
+  size_t i;
+
+  for (i = 0; i < ncatalogs; i++)
+    {
+      char *retval = find_msg (catalogs[i].domain, catalogs[i].binding,
+			       hash, 1, lengthp, msgidp);
+
+      if (retval != NULL)
+	{
+	  /* Returning -1 means that some resource problem exists
+	     (likely memory) and that the strings could not be
+	     converted.  Return the original strings.  */
+	  if (__builtin_expect (retval == (char *) -1, 0))
+	    return NULL;
+
+	  *domainp = catalogs[i].domain;
+	  return retval;
+	}
+    }
+
+  return NULL;
+}
+
+/* Look up MSGID1 in the NCATALOGS catalogs at CATALOGS, in order, and, if
+   PLURAL is nonzero, select the plural form that corresponds to N.  Return
+   NULL if it is not found.  */
+static char *
+find_in_catalogs (const struct context_catalog *catalogs, size_t ncatalogs,
+		  const char *msgid1, int plural, unsigned long int n)
+{
+  struct msgid_hash hash;
+  struct loaded_l10nfile *domain;
+  size_t retlen;
+  char *retval;
+
+  msgid_hash_init (&hash, msgid1);
+  retval = lookup_in_catalogs (catalogs, ncatalogs, &hash, &domain, &retlen,
+			       NULL);
+  if (retval != NULL && plural)
+    retval = plural_lookup (domain, n, retval, retlen, NULL);
+  return retval;
+}
+
+/* Look up MSGID1 in the DOMAINNAME message catalog for the locales of
+   CONTEXT, like DCIGETTEXT does for the LC_MESSAGES category.  */
+static char *
+context_lookup (struct libintl_context *context,
+		const char *domainname,
+		const char *msgid1, const char *msgid2,
+		int plural, unsigned long int n)
+{
+  int saved_errno;
+  struct context_domain *cd;
+  char *retval = NULL;
+
+  /* If no real MSGID is given return NULL.  */
+  if (msgid1 == NULL)
+    return NULL;
+
+  /* Preserve the `errno' value.  */
+  saved_errno = errno;
+
+  if (domainname == NULL)
+    domainname = ATOMIC_LOAD_ACQUIRE (_nl_current_default_domain);
+
+  DOMAIN_STATS_COUNT (domainname, strlen (domainname), catalog_lookups);
+  cd = lock_context_domain (context, domainname);
+  if (cd != NULL)
+    {
+      retval = find_in_catalogs (cd->catalogs, cd->ncatalogs,
+				 msgid1, plural, n);
+      gl_rwlock_unlock (context->lock);
+    }
+
+  if (retval != NULL)
+    {
+      __set_errno (saved_errno);
+      return retval;
+    }
+  note_untranslated (domainname, msgid1, msgid2, plural);
+  __set_errno (saved_errno);
+  return (plural == 0
+	  ? (char *) msgid1
+	  /* Use the Germanic plural rule.  */
+	  : n == 1 ? (char *) msgid1 : (char *) msgid2);
+}
+
+/* Create a translation context for LOCALES.  */
+struct libintl_context *
+libintl_context_create (const char *locales)
+{
+  struct libintl_context *context;
+
+  context = (struct libintl_context *)
+    malloc (sizeof (struct libintl_context));
+  if (context == NULL)
+    return NULL;
+
+  if (locales == NULL)
+    {
+      gl_rwlock_rdlock (_nl_state_lock);
+      locales = guess_category_value (LC_MESSAGES,
+				      category_to_name (LC_MESSAGES));
+      context->locales = strdup (locales);
+      gl_rwlock_unlock (_nl_state_lock);
+    }
+  else
+    context->locales = strdup (locales);
+  if (context->locales == NULL)
+    {
+      free (context);
+      return NULL;
+    }
+
+  gl_rwlock_init (context->lock);
+  context->next = NULL;
+  context->category = LC_MESSAGES;
+  context->domains = NULL;
+  return context;
+}
+
+/* Free CONTEXT.  */
+void
+libintl_context_free (struct libintl_context *context)
+{
+  struct context_domain *cd;
+
+  if (context == NULL)
+    return;
+
+  cd = context->domains;
+  while (cd != NULL)
+    {
+      struct context_domain *next = cd->next;
+
+      free_bindings (cd->bindings, cd->nbindings);
+      free (cd->catalogs);
+      free (cd);
+      cd = next;
+    }
+  gl_rwlock_destroy (context->lock);
+  free (context->locales);
+  free (context);
+}
+
+/* Look up MSGID in the DOMAINNAME message catalog for the locales of
+   CONTEXT.  */
+char *
+libintl_context_dgettext (struct libintl_context *context,
+			  const char *domainname, const char *msgid)
+{
+  return context_lookup (context, domainname, msgid, NULL, 0, 0);
+}
+
+/* Look up MSGID1 in the DOMAINNAME message catalog for the locales of
+   CONTEXT, and select the plural form that corresponds to N.  */
+char *
+libintl_context_dngettext (struct libintl_context *context,
+			   const char *domainname,
+			   const char *msgid1, const char *msgid2,
+			   unsigned long int n)
+{
+  return context_lookup (context, domainname, msgid1, msgid2, 1, n);
+}
+
+
+/* The message catalogs of a domain, resolved once and for all for a list
+   of locales and an output charset.  */
+struct libintl_catalog
+{
+  struct context_catalog *catalogs;
+  size_t ncatalogs;
+  struct binding **bindings;
+  size_t nbindings;
+  /* The domain name, for the counters of the lookups.  */
+  char domainname[ZERO];
+};
+
+/* Resolve the message catalogs of DOMAINNAME for LOCALES and CODESET.  */
+struct libintl_catalog *
+libintl_open_catalog (const char *domainname, const char *locales,
+		      const char *codeset)
+{
+  struct libintl_catalog *catalog;
+  struct context_domain resolved;
+  size_t len;
+  int ok;
+
+  gl_rwlock_rdlock (_nl_state_lock);
+
+  if (domainname == NULL)
+    domainname = _nl_current_default_domain;
+  len = strlen (domainname) + 1;
+  catalog = (struct libintl_catalog *)
+    malloc (offsetof (struct libintl_catalog, domainname) + len);
+  if (catalog == NULL)
+    {
+      gl_rwlock_unlock (_nl_state_lock);
+      return NULL;
+    }
+  memcpy (catalog->domainname, domainname, len);
+  if (locales == NULL)
+    locales = guess_category_value (LC_MESSAGES,
+				    category_to_name (LC_MESSAGES));
+  ok = resolve_context_domain (locales, domainname, LC_MESSAGES, codeset,
+			       &resolved);
+
+  gl_rwlock_unlock (_nl_state_lock);
+
+  if (!ok)
+    {
+      free (catalog);
+      return NULL;
+    }
+
+  catalog->catalogs = resolved.catalogs;
+  catalog->ncatalogs = resolved.ncatalogs;
+  catalog->bindings = resolved.bindings;
+  catalog->nbindings = resolved.nbindings;
+  return catalog;
+}
+
+/* Free CATALOG.  */
+void
+libintl_close_catalog (struct libintl_catalog *catalog)
+{
+  if (catalog == NULL)
+    return;
+
+  free_bindings (catalog->bindings, catalog->nbindings);
+  free (catalog->catalogs);
+  free (catalog);
+}
+
+/* Look up MSGID in CATALOG.  */
+char *
+libintl_handle_gettext (struct libintl_catalog *catalog, const char *msgid)
+{
+  int saved_errno;
+  char *retval;
+
+  /* If no real MSGID is given return NULL.  */
+  if (msgid == NULL)
+    return NULL;
+
+  saved_errno = errno;
+  DOMAIN_STATS_COUNT (catalog->domainname, strlen (catalog->domainname),
+		      catalog_lookups);
+  retval = find_in_catalogs (catalog->catalogs, catalog->ncatalogs,
+			     msgid, 0, 0);
+  if (retval == NULL)
+    {
+      note_untranslated (catalog->domainname, msgid, NULL, 0);
+      retval = (char *) msgid;
+    }
+  __set_errno (saved_errno);
+  return retval;
+}
+
+/* Look up MSGID1 in CATALOG, and select the plural form that corresponds
+   to N.  */
+char *
+libintl_handle_ngettext (struct libintl_catalog *catalog,
+			 const char *msgid1, const char *msgid2,
+			 unsigned long int n)
+{
+  int saved_errno;
+  char *retval;
+
+  /* If no real MSGID is given return NULL.  */
+  if (msgid1 == NULL)
+    return NULL;
+
+  saved_errno = errno;
+  DOMAIN_STATS_COUNT (catalog->domainname, strlen (catalog->domainname),
+		      catalog_lookups);
+  retval = find_in_catalogs (catalog->catalogs, catalog->ncatalogs,
+			     msgid1, 1, n);
+  if (retval == NULL)
+    {
+      note_untranslated (catalog->domainname, msgid1, msgid2, 1);
+      retval = (n == 1 ? (char *) msgid1 : (char *) msgid2);
+    }
+  __set_errno (saved_errno);
+  return retval;
+}
+
+
+/* How many messages ahead libintl_dcgettext_batch fetches the descriptors
+   of a message.  It fetches its hash table entry twice as far ahead.  */
+#define BATCH_PREFETCH_DISTANCE 4
+
+#if defined __GNUC__ \
+    && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 1))
+# define prefetch(addr) __builtin_prefetch (addr)
 #else
-  categoryvalue = guess_category_value (category, categoryname);
+# define prefetch(addr) ((void) (addr))
+#endif
+
+/* The translation contexts that libintl_dcgettext_batch uses, one per
+   list of locales and category.  They keep the message catalogs resolved
+   from one call to the next.  */
+static struct libintl_context *batch_contexts;
+
+/* Protects BATCH_CONTEXTS.  */
+gl_lock_define_initialized (static, batch_contexts_lock)
+
+/* Return the translation context of libintl_dcgettext_batch for LOCALES
+   and CATEGORY, or NULL if memory was exhausted.  */
+static struct libintl_context *
+find_batch_context (const char *locales, int category)
+{
+  struct libintl_context *context;
+
+  gl_lock_lock (batch_contexts_lock);
+
+  for (context = batch_contexts; context != NULL; context = context->next)
+    if (context->category == category
+	&& strcmp (context->locales, locales) == 0)
+      break;
+
+  if (context == NULL)
+    {
+      context = libintl_context_create (locales);
+      if (context != NULL)
+	{
+	  context->category = category;
+	  context->next = batch_contexts;
+	  batch_contexts = context;
+	}
+    }
+
+  gl_lock_unlock (batch_contexts_lock);
+
+  return context;
+}
+
+/* The state of a message during libintl_dcgettext_batch.  */
+struct batch_state
+{
+  /* The message as it is looked up, and its hash values.  Its msgid is
+     NULL if the message has none.  */
+  struct msgid_hash hash;
+  /* The hash table entry of the first catalog at which the lookup of the
+     message starts, or NULL.  */
+  const nls_uint32 *entry;
+  /* Nonzero if the translation was found among the known translations.  */
+  int known;
+};
+
+/* Ask the processor to fetch the hash table entry of DOMAIN at which the
+   lookup of the message of HASH starts.  Return this entry, or NULL if
+   DOMAIN has no hash table.  */
+static const nls_uint32 *
+prefetch_hash_entry (const struct loaded_domain *domain,
+		     struct msgid_hash *hash)
+{
+  const nls_uint32 *entry;
+
+  if (domain->hash2_tab != NULL)
+    entry = domain->hash2_tab
+	    + 2 * (msgid_hash_murmur3 (hash) & (domain->hash2_size - 1));
+  else if (domain->hash_tab != NULL)
+    entry = domain->hash_tab
+	    + (nls_uint32) msgid_hash_pjw (hash) % domain->hash_size;
+  else
+    return NULL;
+
+  prefetch (entry);
+  return entry;
+}
+
+/* Ask the processor to fetch the descriptors of the original string and of
+   the translation that ENTRY, a hash table entry of DOMAIN, refers to.  */
+static void
+prefetch_descriptors (const struct loaded_domain *domain,
+		      const nls_uint32 *entry)
+{
+  nls_uint32 nstr = W (domain->must_swap_hash_tab, entry[0]);
+
+  if (nstr != 0 && nstr - 1 < domain->nstrings)
+    {
+      prefetch (&domain->orig_tab[nstr - 1]);
+      prefetch (&domain->trans_tab[nstr - 1]);
+    }
+}
+
+/* Prepare the lookup of MESSAGE, whose state is STATE: take its translation
+   from the known translations if it is there, or else fetch the hash table
+   entry of FIRST, if not NULL, at which its lookup starts.  SEARCH holds
+   the parts of the key of the known translations that are common to all
+   messages, and CONTEXT_HVAL their hash code.  */
+static void
+prepare_batch_message (struct libintl_batch_message *message,
+		       struct batch_state *state,
+		       const struct loaded_domain *first,
+		       struct known_translation_key *search,
+		       unsigned long int context_hval)
+{
+  state->entry = NULL;
+  state->known = 0;
+  if (state->hash.msgid == NULL)
+    return;
+
+#ifdef HAVE_PER_THREAD_LOCALE
+  {
+    struct known_translation_t entry;
+
+    search->msgid = state->hash.msgid;
+    search->hash =
+      known_translation_hash (msgid_hash_murmur3 (&state->hash),
+			      context_hval);
+    if (known_translation_lookup (search, &entry))
+      {
+	message->translation =
+	  (message->msgid_plural != NULL
+	   ? plural_lookup (entry.value.domain, message->n,
+			    entry.value.translation,
+			    entry.value.translation_length,
+			    entry.value.plural_offsets)
+	   : entry.value.translation);
+	state->known = 1;
+	return;
+      }
+  }
+#endif
+
+  if (first != NULL)
+    state->entry = prefetch_hash_entry (first, &state->hash);
+}
+
+/* Look up the COUNT messages at MESSAGES in the DOMAINNAME message catalog
+   for the current CATEGORY locale.  */
+size_t
+libintl_dcgettext_batch (const char *domainname,
+			 struct libintl_batch_message *messages, size_t count,
+			 int category)
+{
+  int saved_errno;
+  const char *locales;
+  struct libintl_context *context;
+  struct context_domain *cd;
+  struct known_translation_key search;
+  unsigned long int context_hval = 0;
+  struct batch_state *states;
+  char *keymem;
+  size_t keymem_size;
+  const struct loaded_domain *first;
+  size_t found;
+  size_t i;
+
+  if (count == 0)
+    return 0;
+
+  /* Preserve the `errno' value.  */
+  saved_errno = errno;
+
+  /* OS/2 specific: backward compatibility with older libintl versions  */
+#ifdef LC_MESSAGES_COMPAT
+  if (category == LC_MESSAGES_COMPAT)
+    category = LC_MESSAGES;
 #endif
 
-  domainname_len = strlen (domainname);
-  xdomainname = (char *) alloca (strlen (categoryname)
-				 + domainname_len + 5);
-  ADD_BLOCK (block_list, xdomainname);
+  /* The messages with a context are looked up as MSGCTXT "\004" MSGID, like
+     pgettext() does.  */
+  keymem_size = 0;
+  for (i = 0; i < count; i++)
+    if (messages[i].msgctxt != NULL && messages[i].msgid != NULL)
+      keymem_size += strlen (messages[i].msgctxt) + 1
+		     + strlen (messages[i].msgid) + 1;
 
-  stpcpy ((char *) mempcpy (stpcpy (stpcpy (xdomainname, categoryname), "/"),
-			    domainname, domainname_len),
-	  ".mo");
+  states = (struct batch_state *) malloc (count * sizeof (struct batch_state));
+  keymem = (keymem_size > 0 ? (char *) malloc (keymem_size) : NULL);
+  cd = NULL;
+  if (states != NULL && (keymem_size == 0 || keymem != NULL))
+    {
+      char *p = keymem;
 
-  /* Creating working area.  */
-  single_locale = (char *) alloca (strlen (categoryvalue) + 1);
-  ADD_BLOCK (block_list, single_locale);
+      for (i = 0; i < count; i++)
+	if (messages[i].msgctxt != NULL && messages[i].msgid != NULL)
+	  {
+	    msgid_hash_init (&states[i].hash, p);
+	    p = stpcpy (stpcpy (stpcpy (p, messages[i].msgctxt), "\004"),
+			messages[i].msgid) + 1;
+	  }
+	else if (messages[i].msgid != NULL)
+	  msgid_hash_init (&states[i].hash, messages[i].msgid);
+	else
+	  states[i].hash.msgid = NULL;
+
+      /* Find the catalogs once for all messages.  They are kept for the
+	 next calls with the same locales.  */
+      gl_rwlock_rdlock (_nl_state_lock);
+      if (domainname == NULL)
+	domainname = ATOMIC_LOAD_ACQUIRE (_nl_current_default_domain);
+      locales = guess_category_value (category, category_to_name (category));
+      context = find_batch_context (locales, category);
+      gl_rwlock_unlock (_nl_state_lock);
 
+      if (context != NULL)
+	cd = lock_context_domain (context, domainname);
+    }
 
-  /* Search for the given string.  This is a loop because we perhaps
-     got an ordered list of languages to consider for the translation.  */
-  while (1)
+  /* Like DCIGETTEXT, hold _nl_state_lock for reading while the catalogs
+     are searched and the translations remembered, so that
+     libintl_reload_domain cannot forget the known translations in between.
+     It is taken after CONTEXT->lock, because lock_context_domain may take
+     it itself.  */
+  if (cd != NULL)
+    gl_rwlock_rdlock (_nl_state_lock);
+
+  found = 0;
+  if (cd != NULL)
     {
-      /* Make CATEGORYVALUE point to the next element of the list.  */
-      while (categoryvalue[0] != '\0' && categoryvalue[0] == ':')
-	++categoryvalue;
-      if (categoryvalue[0] == '\0')
-	{
-	  /* The whole contents of CATEGORYVALUE has been searched but
-	     no valid entry has been found.  We solve this situation
-	     by implicitly appending a "C" entry, i.e. no translation
-	     will take place.  */
-	  single_locale[0] = 'C';
-	  single_locale[1] = '\0';
-	}
-      else
+#ifdef HAVE_PER_THREAD_LOCALE
+      const char *localename =
+	_nl_locale_name_thread_unsafe (category, category_to_name (category));
+
+      /* The translations are first looked up among the known translations,
+	 like DCIGETTEXT does.  */
+      search.domainname = domainname;
+      search.category = category;
+      search.localename = (localename != NULL ? localename : "");
+      context_hval = known_translation_context_hash (&search);
+#endif
+
+      /* The translations are looked up in the first catalog, the one of the
+	 most specific locale, more often than in the others.  While a
+	 message is looked up, fetch the hash table entries of the next
+	 messages in this catalog, and the descriptors these entries refer
+	 to.  */
+      first = (cd->ncatalogs > 0
+	       ? (const struct loaded_domain *)
+		 ATOMIC_LOAD_ACQUIRE (cd->catalogs[0].domain->data)
+	       : NULL);
+      for (i = 0; i < count && i < 2 * BATCH_PREFETCH_DISTANCE; i++)
+	prepare_batch_message (&messages[i], &states[i], first, &search,
+			       context_hval);
+
+      for (i = 0; i < count; i++)
 	{
-	  char *cp = single_locale;
-	  while (categoryvalue[0] != '\0' && categoryvalue[0] != ':')
-	    *cp++ = *categoryvalue++;
-	  *cp = '\0';
+	  struct libintl_batch_message *message = &messages[i];
+	  struct batch_state *state = &states[i];
+	  struct loaded_l10nfile *domain;
+	  size_t retlen;
+	  const char *found_msgid;
+	  char *translation;
+	  size_t ahead;
+
+	  ahead = i + 2 * BATCH_PREFETCH_DISTANCE;
+	  if (ahead < count)
+	    prepare_batch_message (&messages[ahead], &states[ahead], first,
+				   &search, context_hval);
+	  ahead = i + BATCH_PREFETCH_DISTANCE;
+	  if (ahead < count && states[ahead].entry != NULL)
+	    prefetch_descriptors (first, states[ahead].entry);
+
+	  if (state->hash.msgid == NULL)
+	    {
+	      message->translation = NULL;
+	      continue;
+	    }
+	  if (state->known)
+	    {
+	      DOMAIN_STATS_COUNT (domainname, strlen (domainname), cache_hits);
+	      found++;
+	      continue;
+	    }
 
-	  /* When this is a SUID binary we must not allow accessing files
-	     outside the dedicated directories.  */
-	  if (ENABLE_SECURE && IS_PATH_WITH_DIR (single_locale))
-	    /* Ingore this entry.  */
-	    continue;
+	  DOMAIN_STATS_COUNT (domainname, strlen (domainname),
+			      catalog_lookups);
+	  translation =
+	    lookup_in_catalogs (cd->catalogs, cd->ncatalogs, &state->hash,
+				&domain, &retlen, &found_msgid);
+	  if (translation != NULL)
+	    {
+#ifdef HAVE_PER_THREAD_LOCALE
+	      /* SEARCH was last filled in for a later message.  */
+	      search.msgid = state->hash.msgid;
+	      search.hash =
+		known_translation_hash (msgid_hash_murmur3 (&state->hash),
+					context_hval);
+	      known_translation_remember (&search, found_msgid, domain,
+					  translation, retlen);
+#endif
+	      if (message->msgid_plural != NULL)
+		translation =
+		  plural_lookup (domain, message->n, translation, retlen, NULL);
+	      message->translation = translation;
+	      found++;
+	    }
+	  else
+	    {
+	      message->translation =
+		(message->msgid_plural != NULL && message->n != 1
+		 ? message->msgid_plural
+		 : message->msgid);
+	      note_untranslated (domainname, state->hash.msgid,
+				 message->msgid_plural,
+				 message->msgid_plural != NULL);
+	    }
 	}
 
-      /* If the current locale value is C (or POSIX) we don't load a
-	 domain.  Return the MSGID.  */
-      if (strcmp (single_locale, "C") == 0
-	  || strcmp (single_locale, "POSIX") == 0)
-	break;
-
-      /* Find structure describing the message catalog matching the
-	 DOMAINNAME and CATEGORY.  */
-      domain = _nl_find_domain (dirname, single_locale, xdomainname, binding);
+      gl_rwlock_unlock (_nl_state_lock);
+      gl_rwlock_unlock (context->lock);
+    }
+  else
+    /* Memory is exhausted.  Return the untranslated messages.  */
+    for (i = 0; i < count; i++)
+      {
+	struct libintl_batch_message *message = &messages[i];
 
-      if (domain != NULL)
-	{
-#if defined IN_LIBGLOCALE
-	  retval = _nl_find_msg (domain, binding, encoding, msgid1, &retlen);
-#else
-	  retval = _nl_find_msg (domain, binding, msgid1, 1, &retlen);
-#endif
+	message->translation =
+	  (message->msgid_plural != NULL && message->n != 1
+	   ? message->msgid_plural
+	   : message->msgid);
+      }
 
-	  if (retval == NULL)
-	    {
-	      int cnt;
+  free (keymem);
+  free (states);
 
-	      for (cnt = 0; domain->successor[cnt] != NULL; ++cnt)
-		{
-#if defined IN_LIBGLOCALE
-		  retval = _nl_find_msg (domain->successor[cnt], binding,
-					 encoding, msgid1, &retlen);
-#else
-		  retval = _nl_find_msg (domain->successor[cnt], binding,
-					 msgid1, 1, &retlen);
+  __set_errno (saved_errno);
+  return found;
+}
 #endif
 
-		  if (retval != NULL)
-		    {
-		      domain = domain->successor[cnt];
-		      break;
-		    }
-		}
-	    }
 
-	  /* Returning -1 means that some resource problem exists
-	     (likely memory) and that the strings could not be
-	     converted.  Return the original strings.  */
-	  if (__builtin_expect (retval == (char *) -1, 0))
-	    break;
+#if defined _LIBC || HAVE_ICONV
+# ifndef _LIBC
+/* Whether the translations of a catalog are converted all at once: 1 or 0,
+   or -1 if not yet determined.  */
+static int eager_conversion = -1;
+
+#  ifndef IN_LIBGLOCALE
+/* Set whether the translations of a catalog are converted all at once,
+   when they are first needed in a given encoding.  */
+void
+libintl_set_eager_conversion (int enable)
+{
+  ATOMIC_STORE_RELAXED (eager_conversion, enable != 0);
+}
+#  endif
 
-	  if (retval != NULL)
-	    {
-	      /* Found the translation of MSGID1 in domain DOMAIN:
-		 starting at RETVAL, RETLEN bytes.  */
-	      FREE_BLOCKS (block_list);
-	      if (foundp == NULL)
-		{
-		  /* Create a new entry and add it to the search tree.  */
-		  size_t msgid_len;
-		  size_t size;
-		  struct known_translation_t *newp;
-
-		  msgid_len = strlen (msgid1) + 1;
-		  size = offsetof (struct known_translation_t, msgid)
-			 + msgid_len + domainname_len + 1;
-#ifdef HAVE_PER_THREAD_LOCALE
-		  size += strlen (localename) + 1;
-#endif
-		  newp = (struct known_translation_t *) malloc (size);
-		  if (newp != NULL)
-		    {
-		      char *new_domainname;
-#ifdef HAVE_PER_THREAD_LOCALE
-		      char *new_localename;
-#endif
+/* Return whether the translations of a catalog are converted all at once.
+   Unless it was set through libintl_set_eager_conversion, it is taken from
+   the GETTEXT_EAGER_CONVERSION environment variable.  */
+static int
+get_eager_conversion (void)
+{
+  int eager = ATOMIC_LOAD_RELAXED (eager_conversion);
 
-		      new_domainname =
-			(char *) mempcpy (newp->msgid.appended, msgid1,
-					  msgid_len);
-		      memcpy (new_domainname, domainname, domainname_len + 1);
-#ifdef HAVE_PER_THREAD_LOCALE
-		      new_localename = new_domainname + domainname_len + 1;
-		      strcpy (new_localename, localename);
-#endif
-		      newp->domainname = new_domainname;
-		      newp->category = category;
-#ifdef HAVE_PER_THREAD_LOCALE
-		      newp->localename = new_localename;
-#endif
-#ifdef IN_LIBGLOCALE
-		      newp->encoding = encoding;
-#endif
-		      newp->counter = _nl_msg_cat_cntr;
-		      newp->domain = domain;
-		      newp->translation = retval;
-		      newp->translation_length = retlen;
+  if (eager < 0)
+    {
+      const char *value = getenv ("GETTEXT_EAGER_CONVERSION");
 
-		      gl_rwlock_wrlock (tree_lock);
+      eager = (value != NULL && value[0] != '\0' && strcmp (value, "0") != 0);
+      ATOMIC_STORE_RELAXED (eager_conversion, eager);
+    }
 
-		      /* Insert the entry in the search tree.  */
-		      foundp = (struct known_translation_t **)
-			tsearch (newp, &root, transcmp);
+  return eager;
+}
+# else
+/* In glibc, translations are always converted one at a time.  */
+#  define get_eager_conversion() 0
+# endif
 
-		      gl_rwlock_unlock (tree_lock);
+/* Return values of convert_string, besides the length of the output.  */
+# define CONVERT_FULL ((size_t) -1)
+# define CONVERT_INVALID ((size_t) -2)
+
+/* Convert the LEN bytes at INBUF with CONVD->conv and store the result in
+   the OUTSIZE bytes at OUTBUF.  Return the length of the result, or
+   CONVERT_FULL if OUTSIZE is too small, or CONVERT_INVALID if the input is
+   not correctly encoded.  The caller must hold CONVD->lock, or be the only
+   user of CONVD.  */
+static size_t
+convert_string (struct converted_domain *convd,
+		const char *inbuf, size_t len,
+		unsigned char *outbuf, size_t outsize)
+{
+# ifdef _LIBC
+  const unsigned char *inptr = (const unsigned char *) inbuf;
+  unsigned char *outptr = outbuf;
+  size_t non_reversible;
+  int res;
+
+  res = __gconv (convd->conv, &inptr, inptr + len, &outptr, outbuf + outsize,
+		 &non_reversible);
+  if (res == __GCONV_OK || res == __GCONV_EMPTY_INPUT)
+    return outptr - outbuf;
+  return (res == __GCONV_FULL_OUTPUT ? CONVERT_FULL : CONVERT_INVALID);
+# else
+  const char *inptr = inbuf;
+  size_t inleft = len;
+  char *outptr = (char *) outbuf;
+  size_t outleft = outsize;
+
+  if (iconv (convd->conv,
+	     (ICONV_CONST char **) &inptr, &inleft, &outptr, &outleft)
+      != (size_t) (-1))
+    return outptr - (char *) outbuf;
+  if (errno != E2BIG)
+    return CONVERT_INVALID;
+  /* Return to the initial state before the caller starts over.  */
+  iconv (convd->conv, NULL, NULL, NULL, NULL);
+  return CONVERT_FULL;
+# endif
+}
 
-		      if (foundp == NULL
-			  || __builtin_expect (*foundp != newp, 0))
-			/* The insert failed.  */
-			free (newp);
-		    }
-		}
-	      else
-		{
-		  /* We can update the existing entry.  */
-		  (*foundp)->counter = _nl_msg_cat_cntr;
-		  (*foundp)->domain = domain;
-		  (*foundp)->translation = retval;
-		  (*foundp)->translation_length = retlen;
-		}
+/* Convert all translations of DOMAIN with CONVD into a single block of
+   memory, and fill CONVD->conv_tab with pointers into it.  Translations
+   that are not correctly encoded are left to the conversion on demand,
+   which will reject them.  CONVD must not be visible to other threads
+   yet.  Upon memory allocation failure, CONVD is left unchanged, and the
+   translations are converted one at a time.  */
+static void
+convert_domain (const struct loaded_domain *domain,
+		struct converted_domain *convd)
+{
+  size_t nstrings = domain->nstrings + domain->n_sysdep_strings;
+  size_t *offsets;
+  char **conv_tab;
+  unsigned char *mem;
+  size_t size;
+  size_t used;
+  size_t i;
+
+  if (nstrings == 0)
+    return;
+
+  /* Start with the size of the unconverted translations, and a quarter
+     more for multibyte encodings.  */
+  size = 0;
+  for (i = 0; i < nstrings; i++)
+    size += (i < domain->nstrings
+	     ? W (domain->must_swap, domain->trans_tab[i].length) + 1
+	     : domain->trans_sysdep_tab[i - domain->nstrings].length)
+	    + 2 * sizeof (size_t);
+  size += size / 4;
+
+  offsets = (size_t *) malloc (nstrings * sizeof (size_t));
+  conv_tab = (char **) calloc (nstrings, sizeof (char *));
+  mem = (unsigned char *) malloc (size);
+  if (offsets == NULL || conv_tab == NULL || mem == NULL)
+    goto fail;
+
+  used = 0;
+  for (i = 0; i < nstrings; i++)
+    {
+      const char *str;
+      size_t len;
+      size_t outlen;
 
-	      __set_errno (saved_errno);
+      if (i < domain->nstrings)
+	{
+	  str = domain->data + W (domain->must_swap,
+				  domain->trans_tab[i].offset);
+	  len = W (domain->must_swap, domain->trans_tab[i].length) + 1;
+	}
+      else
+	{
+	  str = domain->trans_sysdep_tab[i - domain->nstrings].pointer;
+	  len = domain->trans_sysdep_tab[i - domain->nstrings].length;
+	}
 
-	      /* Now deal with plural.  */
-	      if (plural)
-		retval = plural_lookup (domain, n, retval, retlen);
+      /* Keep each converted string aligned, since it starts with its
+	 length.  When the previous string ended at the end of MEM, this
+	 moves USED beyond SIZE.  */
+      used = (used + alignof (size_t) - 1) & ~ (alignof (size_t) - 1);
+      for (;;)
+	{
+	  unsigned char *newmem;
 
-	      gl_rwlock_unlock (_nl_state_lock);
-#ifdef _LIBC
-	      __libc_rwlock_unlock (__libc_setlocale_lock);
-#endif
-	      return retval;
+	  if (used + sizeof (size_t) < size)
+	    {
+	      outlen = convert_string (convd, str, len,
+				       mem + used + sizeof (size_t),
+				       size - used - sizeof (size_t));
+	      if (outlen != CONVERT_FULL)
+		break;
 	    }
+	  size = 2 * size + len;
+	  newmem = (unsigned char *) realloc (mem, size);
+	  if (newmem == NULL)
+	    goto fail;
+	  mem = newmem;
+	}
+
+      if (outlen == CONVERT_INVALID)
+	offsets[i] = (size_t) -1;
+      else
+	{
+	  *(size_t *) (mem + used) = outlen;
+	  offsets[i] = used;
+	  used += sizeof (size_t) + outlen;
 	}
     }
 
- return_untranslated:
-  /* Return the untranslated MSGID.  */
-  FREE_BLOCKS (block_list);
-  gl_rwlock_unlock (_nl_state_lock);
-#ifdef _LIBC
-  __libc_rwlock_unlock (__libc_setlocale_lock);
-#endif
-#ifndef _LIBC
-  if (!ENABLE_SECURE)
+  /* Give back the memory that was not needed.  */
+  if (used > 0 && used < size)
     {
-      extern void _nl_log_untranslated (const char *logfilename,
-					const char *domainname,
-					const char *msgid1, const char *msgid2,
-					int plural);
-      const char *logfilename = getenv ("GETTEXT_LOG_UNTRANSLATED");
+      unsigned char *newmem = (unsigned char *) realloc (mem, used);
 
-      if (logfilename != NULL && logfilename[0] != '\0')
-	_nl_log_untranslated (logfilename, domainname, msgid1, msgid2, plural);
+      if (newmem != NULL)
+	mem = newmem;
     }
-#endif
-  __set_errno (saved_errno);
-  return (plural == 0
-	  ? (char *) msgid1
-	  /* Use the Germanic plural rule.  */
-	  : n == 1 ? (char *) msgid1 : (char *) msgid2);
+
+  for (i = 0; i < nstrings; i++)
+    if (offsets[i] != (size_t) -1)
+      conv_tab[i] = (char *) mem + offsets[i];
+  free (offsets);
+
+  convd->conv_tab = conv_tab;
+  convd->conv_mem = (char *) mem;
+  return;
+
+ fail:
+  free (mem);
+  free (conv_tab);
+  free (offsets);
 }
+#endif
 
 
 /* Look up the translation of msgid within DOMAIN_FILE and DOMAINBINDING.
@@ -881,14 +3168,43 @@ internal_function
 _nl_find_msg (struct loaded_l10nfile *domain_file,
 	      struct binding *domainbinding, const char *encoding,
 	      const char *msgid,
-	      size_t *lengthp)
+	      size_t *lengthp, const char **msgidp)
 #else
 _nl_find_msg (struct loaded_l10nfile *domain_file,
 	      struct binding *domainbinding,
 	      const char *msgid, int convert,
-	      size_t *lengthp)
+	      size_t *lengthp, const char **msgidp)
+#endif
+{
+  struct msgid_hash hash;
+
+  msgid_hash_init (&hash, msgid);
+#ifdef IN_LIBGLOCALE
+  return find_msg (domain_file, domainbinding, encoding, &hash,
+		   lengthp, msgidp);
+#else
+  return find_msg (domain_file, domainbinding, &hash, convert,
+		   lengthp, msgidp);
+#endif
+}
+
+/* Like _nl_find_msg, for the message of HASH.  HASH remembers the hash
+   values of the message that this lookup computes, for the lookups of
+   the same message in other catalogs.  */
+static char *
+internal_function
+#ifdef IN_LIBGLOCALE
+find_msg (struct loaded_l10nfile *domain_file,
+	  struct binding *domainbinding, const char *encoding,
+	  struct msgid_hash *hash,
+	  size_t *lengthp, const char **msgidp)
+#else
+find_msg (struct loaded_l10nfile *domain_file,
+	  struct binding *domainbinding, struct msgid_hash *hash,
+	  int convert, size_t *lengthp, const char **msgidp)
 #endif
 {
+  const char *msgid = hash->msgid;
   struct loaded_domain *domain;
   nls_uint32 nstrings;
   size_t act;
@@ -898,26 +3214,53 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
   if (domain_file->decided <= 0)
     _nl_load_domain (domain_file, domainbinding);
 
-  if (domain_file->data == NULL)
+  /* The data is replaced when the catalog is reloaded.  */
+  domain = (struct loaded_domain *) ATOMIC_LOAD_ACQUIRE (domain_file->data);
+  if (domain == NULL)
     return NULL;
 
-  domain = (struct loaded_domain *) domain_file->data;
-
   nstrings = domain->nstrings;
 
   /* Locate the MSGID and its translation.  */
   if (domain->hash_tab != NULL)
     {
       /* Use the hashing table.  */
-      nls_uint32 len = strlen (msgid);
-      nls_uint32 hash_val = __hash_string (msgid);
-      nls_uint32 idx = hash_val % domain->hash_size;
-      nls_uint32 incr = 1 + (hash_val % (domain->hash_size - 2));
+      nls_uint32 len = msgid_hash_len (hash);
+      nls_uint32 hash_size;
+      const nls_uint32 *hash_tab;
+      nls_uint32 idx;
+      nls_uint32 incr;
+      /* The entries of the secondary table carry fingerprints: they are 2
+	 words wide, and only entries whose fingerprint is equal to the hash
+	 value of MSGID need a string comparison.  Equal fingerprints don't
+	 imply equal lengths, so the lengths are compared nevertheless.  */
+      int fingerprints = 0;
+      nls_uint32 hash_val = 0;
+
+      if (domain->hash2_tab != NULL)
+	{
+	  /* Prefer the table built with the word-at-a-time hash function.
+	     Its size is a power of 2, and it uses linear probing.  */
+	  hash_size = domain->hash2_size;
+	  hash_tab = domain->hash2_tab;
+	  fingerprints = 1;
+	  hash_val = msgid_hash_murmur3 (hash);
+	  idx = hash_val & (hash_size - 1);
+	  incr = 1;
+	}
+      else
+	{
+	  hash_val = msgid_hash_pjw (hash);
+	  hash_size = domain->hash_size;
+	  hash_tab = domain->hash_tab;
+	  idx = hash_val % hash_size;
+	  incr = 1 + (hash_val % (hash_size - 2));
+	}
 
       while (1)
 	{
-	  nls_uint32 nstr =
-	    W (domain->must_swap_hash_tab, domain->hash_tab[idx]);
+	  const nls_uint32 *entry = hash_tab + (fingerprints ? 2 * idx : idx);
+	  nls_uint32 nstr = W (domain->must_swap_hash_tab, entry[0]);
 
 	  if (nstr == 0)
 	    /* Hash table entry is empty.  */
@@ -928,23 +3271,26 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 	  /* Compare msgid with the original string at index nstr.
 	     We compare the lengths with >=, not ==, because plural entries
 	     are represented by strings with an embedded NUL.  */
-	  if (nstr < nstrings
-	      ? W (domain->must_swap, domain->orig_tab[nstr].length) >= len
-		&& (strcmp (msgid,
-			    domain->data + W (domain->must_swap,
-					      domain->orig_tab[nstr].offset))
-		    == 0)
-	      : domain->orig_sysdep_tab[nstr - nstrings].length > len
-		&& (strcmp (msgid,
-			    domain->orig_sysdep_tab[nstr - nstrings].pointer)
-		    == 0))
+	  if ((!fingerprints
+	       || W (domain->must_swap_hash_tab, entry[1]) == hash_val)
+	      && (nstr < nstrings
+		  ? W (domain->must_swap, domain->orig_tab[nstr].length) >= len
+		    && (strcmp (msgid,
+				domain->data
+				+ W (domain->must_swap,
+				     domain->orig_tab[nstr].offset))
+			== 0)
+		  : domain->orig_sysdep_tab[nstr - nstrings].length > len
+		    && (strcmp (msgid,
+				domain->orig_sysdep_tab[nstr - nstrings].pointer)
+			== 0)))
 	    {
 	      act = nstr;
 	      goto found;
 	    }
 
-	  if (idx >= domain->hash_size - incr)
-	    idx -= domain->hash_size - incr;
+	  if (idx >= hash_size - incr)
+	    idx -= hash_size - incr;
 	  else
 	    idx += incr;
 	}
@@ -985,11 +3331,16 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
       result = (char *)
 	(domain->data + W (domain->must_swap, domain->trans_tab[act].offset));
       resultlen = W (domain->must_swap, domain->trans_tab[act].length) + 1;
+      if (msgidp != NULL)
+	*msgidp =
+	  domain->data + W (domain->must_swap, domain->orig_tab[act].offset);
     }
   else
     {
       result = (char *) domain->trans_sysdep_tab[act - nstrings].pointer;
       resultlen = domain->trans_sysdep_tab[act - nstrings].length;
+      if (msgidp != NULL)
+	*msgidp = domain->orig_sysdep_tab[act - nstrings].pointer;
     }
 
 #if defined _LIBC || HAVE_ICONV
@@ -1018,9 +3369,9 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
       for (i = nconversions; i > 0; )
 	{
 	  i--;
-	  if (strcmp (domain->conversions[i].encoding, encoding) == 0)
+	  if (strcmp (domain->conversions[i]->encoding, encoding) == 0)
 	    {
-	      convd = &domain->conversions[i];
+	      convd = domain->conversions[i];
 	      break;
 	    }
 	}
@@ -1038,9 +3389,9 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 	  for (i = nconversions; i > 0; )
 	    {
 	      i--;
-	      if (strcmp (domain->conversions[i].encoding, encoding) == 0)
+	      if (strcmp (domain->conversions[i]->encoding, encoding) == 0)
 		{
-		  convd = &domain->conversions[i];
+		  convd = domain->conversions[i];
 		  goto found_convd;
 		}
 	    }
@@ -1048,12 +3399,14 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 	  {
 	    /* Allocate a table for the converted translations for this
 	       encoding.  */
-	    struct converted_domain *new_conversions =
-	      (struct converted_domain *)
+	    struct converted_domain **new_conversions =
+	      (struct converted_domain **)
 	      (domain->conversions != NULL
 	       ? realloc (domain->conversions,
-			  (nconversions + 1) * sizeof (struct converted_domain))
-	       : malloc ((nconversions + 1) * sizeof (struct converted_domain)));
+			  (nconversions + 1)
+			  * sizeof (struct converted_domain *))
+	       : malloc ((nconversions + 1)
+			 * sizeof (struct converted_domain *)));
 
 	    if (__builtin_expect (new_conversions == NULL, 0))
 	      {
@@ -1066,14 +3419,22 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 
 	    domain->conversions = new_conversions;
 
+	    convd =
+	      (struct converted_domain *)
+	      malloc (sizeof (struct converted_domain));
+	    if (__builtin_expect (convd == NULL, 0))
+	      goto unlock_fail;
+
 	    /* Copy the 'encoding' string to permanent storage.  */
 	    encoding = strdup (encoding);
 	    if (__builtin_expect (encoding == NULL, 0))
-	      /* Nothing we can do, no more memory.  We cannot use the
-		 translation because it might be encoded incorrectly.  */
-	      goto unlock_fail;
+	      {
+		/* Nothing we can do, no more memory.  We cannot use the
+		   translation because it might be encoded incorrectly.  */
+		free (convd);
+		goto unlock_fail;
+	      }
 
-	    convd = &new_conversions[nconversions];
 	    convd->encoding = encoding;
 
 	    /* Find out about the character set the file is encoded with.
@@ -1098,9 +3459,10 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 	      nullentry =
 # ifdef IN_LIBGLOCALE
 		_nl_find_msg (domain_file, domainbinding, NULL, "",
-			      &nullentrylen);
+			      &nullentrylen, NULL);
 # else
-		_nl_find_msg (domain_file, domainbinding, "", 0, &nullentrylen);
+		_nl_find_msg (domain_file, domainbinding, "", 0,
+			      &nullentrylen, NULL);
 # endif
 
 	      if (nullentry != NULL)
@@ -1142,6 +3504,7 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 			    {
 			      gl_rwlock_unlock (domain->conversions_lock);
 			      free ((char *) encoding);
+			      free (convd);
 			      return NULL;
 			    }
 
@@ -1179,7 +3542,26 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 		}
 	    }
 	    convd->conv_tab = NULL;
+	    convd->freemem = NULL;
+	    convd->freemem_size = 0;
+	    convd->conv_mem = NULL;
+	    __libc_lock_init (convd->lock);
+
+	    /* If requested, convert all translations now, so that the
+	       lookups don't have to.  */
+	    if (
+# ifdef _LIBC
+		convd->conv != (__gconv_t) -1
+# else
+#  if HAVE_ICONV
+		convd->conv != (iconv_t) -1
+#  endif
+# endif
+		&& get_eager_conversion ())
+	      convert_domain (domain, convd);
+
 	    /* Here domain->conversions is still == new_conversions.  */
+	    new_conversions[nconversions] = convd;
 	    domain->nconversions++;
 	  }
 
@@ -1205,37 +3587,37 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 	     are represented by consecutive NUL terminated strings.  We
 	     handle this case by converting RESULTLEN bytes, including
 	     NULs.  */
+	  char **conv_tab = ATOMIC_LOAD_ACQUIRE (convd->conv_tab);
+	  char *converted;
 
-	  /* This lock primarily protects the memory management variables
-	     freemem, freemem_size.  It also protects write accesses to
-	     convd->conv_tab.  It's not worth using a separate lock (such
-	     as domain->conversions_lock) for this purpose, because when
-	     modifying convd->conv_tab, we also need to lock freemem,
-	     freemem_size for most of the time.  */
-	  __libc_lock_define_initialized (static, lock)
-
-	  if (__builtin_expect (convd->conv_tab == NULL, 0))
+	  if (__builtin_expect (conv_tab == NULL, 0))
 	    {
-	      __libc_lock_lock (lock);
-	      if (convd->conv_tab == NULL)
+	      __libc_lock_lock (convd->lock);
+	      conv_tab = convd->conv_tab;
+	      if (conv_tab == NULL)
 		{
-		  convd->conv_tab =
+		  conv_tab =
 		    (char **) calloc (nstrings + domain->n_sysdep_strings,
 				      sizeof (char *));
-		  if (convd->conv_tab != NULL)
-		    goto not_translated_yet;
+		  if (conv_tab != NULL)
+		    {
+		      ATOMIC_STORE_RELEASE (convd->conv_tab, conv_tab);
+		      goto not_translated_yet;
+		    }
 		  /* Mark that we didn't succeed allocating a table.  */
-		  convd->conv_tab = (char **) -1;
+		  conv_tab = (char **) -1;
+		  convd->conv_tab = conv_tab;
 		}
-	      __libc_lock_unlock (lock);
+	      __libc_lock_unlock (convd->lock);
 	    }
 
-	  if (__builtin_expect (convd->conv_tab == (char **) -1, 0))
+	  if (__builtin_expect (conv_tab == (char **) -1, 0))
 	    /* Nothing we can do, no more memory.  We cannot use the
 	       translation because it might be encoded incorrectly.  */
 	    return (char *) -1;
 
-	  if (convd->conv_tab[act] == NULL)
+	  converted = ATOMIC_LOAD_ACQUIRE (conv_tab[act]);
+	  if (converted == NULL)
 	    {
 	      /* We haven't used this string so far, so it is not
 		 translated yet.  Do this now.  */
@@ -1243,148 +3625,102 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 		 We allocate always larger blocks which get used over
 		 time.  This is faster than many small allocations.   */
 # define INITIAL_BLOCK_SIZE	4080
-	      static unsigned char *freemem;
-	      static size_t freemem_size;
-
-	      const unsigned char *inbuf;
-	      unsigned char *outbuf;
+	      transmem_block_t *transmem;
+	      size_t outlen;
 	      int malloc_count;
-# ifndef _LIBC
-	      transmem_block_t *transmem_list;
-# endif
 
-	      __libc_lock_lock (lock);
+	      __libc_lock_lock (convd->lock);
 	    not_translated_yet:
 
-	      inbuf = (const unsigned char *) result;
-	      outbuf = freemem + sizeof (size_t);
-# ifndef _LIBC
-	      transmem_list = NULL;
-# endif
-
+	      transmem = NULL;
 	      malloc_count = 0;
 	      while (1)
 		{
 		  transmem_block_t *newmem;
-# ifdef _LIBC
-		  size_t non_reversible;
-		  int res;
-
-		  if (freemem_size < sizeof (size_t))
-		    goto resize_freemem;
-
-		  res = __gconv (convd->conv,
-				 &inbuf, inbuf + resultlen,
-				 &outbuf,
-				 outbuf + freemem_size - sizeof (size_t),
-				 &non_reversible);
+		  size_t block_size;
 
-		  if (res == __GCONV_OK || res == __GCONV_EMPTY_INPUT)
-		    break;
-
-		  if (res != __GCONV_FULL_OUTPUT)
-		    {
-		      /* We should not use the translation at all, it
-			 is incorrectly encoded.  */
-		      __libc_lock_unlock (lock);
-		      return NULL;
-		    }
-
-		  inbuf = (const unsigned char *) result;
-# else
-#  if HAVE_ICONV
-		  const char *inptr = (const char *) inbuf;
-		  size_t inleft = resultlen;
-		  char *outptr = (char *) outbuf;
-		  size_t outleft;
-
-		  if (freemem_size < sizeof (size_t))
-		    goto resize_freemem;
-
-		  outleft = freemem_size - sizeof (size_t);
-		  if (iconv (convd->conv,
-			     (ICONV_CONST char **) &inptr, &inleft,
-			     &outptr, &outleft)
-		      != (size_t) (-1))
-		    {
-		      outbuf = (unsigned char *) outptr;
-		      break;
-		    }
-		  if (errno != E2BIG)
+		  if (convd->freemem_size > sizeof (size_t))
 		    {
-		      __libc_lock_unlock (lock);
-		      return NULL;
+		      outlen = convert_string (convd, result, resultlen,
+					       convd->freemem + sizeof (size_t),
+					       convd->freemem_size
+					       - sizeof (size_t));
+		      if (outlen == CONVERT_INVALID)
+			{
+			  /* We should not use the translation at all, it
+			     is incorrectly encoded.  */
+			  __libc_lock_unlock (convd->lock);
+			  return NULL;
+			}
+		      if (outlen != CONVERT_FULL)
+			break;
 		    }
-#  endif
-# endif
 
-		resize_freemem:
 		  /* We must allocate a new buffer or resize the old one.  */
 		  if (malloc_count > 0)
 		    {
 		      ++malloc_count;
-		      freemem_size = malloc_count * INITIAL_BLOCK_SIZE;
-		      newmem = (transmem_block_t *) realloc (transmem_list,
-							     freemem_size);
-# ifdef _LIBC
-		      if (newmem != NULL)
-			transmem_list = transmem_list->next;
-		      else
-			{
-			  struct transmem_list *old = transmem_list;
-
-			  transmem_list = transmem_list->next;
-			  free (old);
-			}
-# endif
+		      block_size = malloc_count * INITIAL_BLOCK_SIZE;
+		      newmem = (transmem_block_t *) realloc (transmem,
+							     block_size);
 		    }
 		  else
 		    {
 		      malloc_count = 1;
-		      freemem_size = INITIAL_BLOCK_SIZE;
-		      newmem = (transmem_block_t *) malloc (freemem_size);
+		      block_size = INITIAL_BLOCK_SIZE;
+		      newmem = (transmem_block_t *) malloc (block_size);
 		    }
 		  if (__builtin_expect (newmem == NULL, 0))
 		    {
-		      freemem = NULL;
-		      freemem_size = 0;
-		      __libc_lock_unlock (lock);
+		      free (transmem);
+		      convd->freemem = NULL;
+		      convd->freemem_size = 0;
+		      __libc_lock_unlock (convd->lock);
 		      return (char *) -1;
 		    }
+		  transmem = newmem;
 
 # ifdef _LIBC
-		  /* Add the block to the list of blocks we have to free
-		     at some point.  */
-		  newmem->next = transmem_list;
-		  transmem_list = newmem;
-
-		  freemem = (unsigned char *) newmem->data;
-		  freemem_size -= offsetof (struct transmem_list, data);
+		  convd->freemem = (unsigned char *) newmem->data;
+		  convd->freemem_size =
+		    block_size - offsetof (struct transmem_list, data);
 # else
-		  transmem_list = newmem;
-		  freemem = newmem;
+		  convd->freemem = newmem;
+		  convd->freemem_size = block_size;
 # endif
+		}
 
-		  outbuf = freemem + sizeof (size_t);
+# ifdef _LIBC
+	      if (transmem != NULL)
+		{
+		  /* Add the block to the list of blocks we have to free
+		     at some point.  */
+		  __libc_lock_lock (transmem_lock);
+		  transmem->next = transmem_list;
+		  transmem_list = transmem;
+		  __libc_lock_unlock (transmem_lock);
 		}
+# endif
 
 	      /* We have now in our buffer a converted string.  Put this
 		 into the table of conversions.  */
-	      *(size_t *) freemem = outbuf - freemem - sizeof (size_t);
-	      convd->conv_tab[act] = (char *) freemem;
+	      converted = (char *) convd->freemem;
+	      *(size_t *) converted = outlen;
+	      ATOMIC_STORE_RELEASE (conv_tab[act], converted);
 	      /* Shrink freemem, but keep it aligned.  */
-	      freemem_size -= outbuf - freemem;
-	      freemem = outbuf;
-	      freemem += freemem_size & (alignof (size_t) - 1);
-	      freemem_size = freemem_size & ~ (alignof (size_t) - 1);
+	      convd->freemem_size -= sizeof (size_t) + outlen;
+	      convd->freemem += sizeof (size_t) + outlen;
+	      convd->freemem += convd->freemem_size & (alignof (size_t) - 1);
+	      convd->freemem_size &= ~ (alignof (size_t) - 1);
 
-	      __libc_lock_unlock (lock);
+	      __libc_lock_unlock (convd->lock);
+	      DOMAIN_STATS_COUNT_FILE (domain_file->filename, conversions);
 	    }
 
-	  /* Now convd->conv_tab[act] contains the translation of all
-	     the plural variants.  */
-	  result = convd->conv_tab[act] + sizeof (size_t);
-	  resultlen = *(size_t *) convd->conv_tab[act];
+	  /* Now conv_tab[act] contains the translation of all the plural
+	     variants.  */
+	  result = converted + sizeof (size_t);
+	  resultlen = *(size_t *) converted;
 	}
     }
 
@@ -1397,21 +3733,59 @@ _nl_find_msg (struct loaded_l10nfile *domain_file,
 }
 
 
-/* Look up a plural variant.  */
-static char *
-internal_function
-plural_lookup (struct loaded_l10nfile *domain, unsigned long int n,
-	       const char *translation, size_t translation_len)
+/* Return the index of the plural form for N in DOMAINDATA.  */
+static inline unsigned long int
+plural_index (const struct loaded_domain *domaindata, unsigned long int n)
 {
-  struct loaded_domain *domaindata = (struct loaded_domain *) domain->data;
   unsigned long int index;
-  const char *p;
 
-  index = plural_eval (domaindata->plural, n);
+  if (domaindata->plural_program != NULL)
+    index = plural_program_eval (domaindata->plural_program, n);
+  else
+    index = plural_eval (domaindata->plural, n);
   if (index >= domaindata->nplurals)
     /* This should never happen.  It means the plural expression and the
        given maximum value do not match.  */
     index = 0;
+  return index;
+}
+
+/* Look up a plural variant.  PLURAL_OFFSETS, if not NULL, are the offsets
+   of the plural forms in TRANSLATION, as stored with the known
+   translations.  */
+static char *
+internal_function
+plural_lookup (struct loaded_l10nfile *domain, unsigned long int n,
+	       const char *translation, size_t translation_len,
+	       const unsigned short *plural_offsets)
+{
+  struct loaded_domain *domaindata =
+    (struct loaded_domain *) ATOMIC_LOAD_ACQUIRE (domain->data);
+  unsigned long int index;
+  const char *p;
+
+  /* The plural form indices of small values of n are remembered.  Threads
+     may fill the same element concurrently, but they store the same
+     value.  */
+  if (n < PLURAL_INDICES_SIZE)
+    {
+      index = ATOMIC_LOAD_RELAXED (domaindata->plural_indices[n]);
+      if (index == PLURAL_INDEX_UNKNOWN)
+	{
+	  index = plural_index (domaindata, n);
+	  if (index < PLURAL_INDEX_UNKNOWN)
+	    ATOMIC_STORE_RELAXED (domaindata->plural_indices[n],
+				  (unsigned char) index);
+	}
+    }
+  else
+    index = plural_index (domaindata, n);
+
+  if (index == 0)
+    return (char *) translation;
+  if (plural_offsets != NULL && index <= KNOWN_TRANSLATION_PLURAL_FORMS
+      && plural_offsets[index - 1] != 0)
+    return (char *) translation + plural_offsets[index - 1];
 
   /* Skip INDEX strings at TRANSLATION.  */
   p = translation;
@@ -1663,10 +4037,6 @@ mempcpy (void *dest, const void *src, size_t n)
 }
 #endif
 
-#if !_LIBC && !HAVE_TSEARCH
-# include "tsearch.c"
-#endif
-
 
 #ifdef _LIBC
 /* If we want to free all resources we have to do some work at
@@ -1683,16 +4053,27 @@ libc_freeres_fn (free_mem)
 	/* Yes, this is a pointer comparison.  */
 	free (oldp->dirname);
       free (oldp->codeset);
+      free (oldp->layers);
       free (oldp);
     }
 
-  if (_nl_current_default_domain != _nl_default_default_domain)
-    /* Yes, again a pointer comparison.  */
-    free ((char *) _nl_current_default_domain);
+  _nl_textdomain_subfreeres ();
+
+  /* Remove the table with the known translations.  */
+  while (known_translations != NULL)
+    {
+      struct known_translation_table *previous = known_translations->previous;
+
+      free (known_translations);
+      known_translations = previous;
+    }
+  while (known_translation_strings != NULL)
+    {
+      struct known_translation_string *next = known_translation_strings->next;
 
-  /* Remove the search tree with the known translations.  */
-  __tdestroy (root, free);
-  root = NULL;
+      free (known_translation_strings);
+      known_translation_strings = next;
+    }
 
   while (transmem_list != NULL)
     {
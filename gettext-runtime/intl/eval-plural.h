@@ -104,3 +104,107 @@ plural_eval (const struct expression *pexp, unsigned long int n)
   /* NOTREACHED */
   return 0;
 }
+
+
+/* Evaluate the compiled plural expression and return an index value.  */
+STATIC
+unsigned long int
+internal_function
+plural_program_eval (const struct plural_program *prog, unsigned long int n)
+{
+  /* The top of the stack is kept in TOP, the rest in STACK.  */
+  unsigned long int stack[PLURAL_STACK_SIZE];
+  unsigned long int *sp;
+  unsigned long int top;
+  unsigned long int left, right;
+  const struct plural_insn *pc;
+
+  if (prog->eval != NULL)
+    return prog->eval (n);
+
+  sp = stack;
+  top = 0;
+  for (pc = prog->insns;; pc++)
+    switch (pc->op)
+      {
+      case PLURAL_OP_VAR:
+	*sp++ = top;
+	top = n;
+	break;
+      case PLURAL_OP_NUM:
+	*sp++ = top;
+	top = pc->arg;
+	break;
+      case PLURAL_OP_NOT:
+	top = !top;
+	break;
+      case PLURAL_OP_BOOL:
+	top = (top != 0);
+	break;
+
+#define BINARY_OP(opcode, expr) \
+      case opcode:							  \
+	right = top;							  \
+	left = *--sp;							  \
+	top = (expr);							  \
+	break;								  \
+      case opcode##_IMM:						  \
+	right = pc->arg;						  \
+	left = top;							  \
+	top = (expr);							  \
+	break;								  \
+      case opcode##_VAR_IMM:						  \
+	*sp++ = top;							  \
+	right = pc->arg;						  \
+	left = n;							  \
+	top = (expr);							  \
+	break;
+
+      BINARY_OP (PLURAL_OP_MULT, left * right)
+      BINARY_OP (PLURAL_OP_PLUS, left + right)
+      BINARY_OP (PLURAL_OP_MINUS, left - right)
+      BINARY_OP (PLURAL_OP_LESS_THAN, left < right)
+      BINARY_OP (PLURAL_OP_GREATER_THAN, left > right)
+      BINARY_OP (PLURAL_OP_LESS_OR_EQUAL, left <= right)
+      BINARY_OP (PLURAL_OP_GREATER_OR_EQUAL, left >= right)
+      BINARY_OP (PLURAL_OP_EQUAL, left == right)
+      BINARY_OP (PLURAL_OP_NOT_EQUAL, left != right)
+#if !INTDIV0_RAISES_SIGFPE
+      BINARY_OP (PLURAL_OP_DIVIDE,
+		 (right == 0 ? raise (SIGFPE) : 0, left / right))
+      BINARY_OP (PLURAL_OP_MODULE,
+		 (right == 0 ? raise (SIGFPE) : 0, left % right))
+#else
+      BINARY_OP (PLURAL_OP_DIVIDE, left / right)
+      BINARY_OP (PLURAL_OP_MODULE, left % right)
+#endif
+#undef BINARY_OP
+
+      case PLURAL_OP_AND_JUMP:
+	if (top == 0)
+	  pc = prog->insns + pc->arg - 1;
+	else
+	  top = *--sp;
+	break;
+      case PLURAL_OP_OR_JUMP:
+	if (top != 0)
+	  {
+	    top = 1;
+	    pc = prog->insns + pc->arg - 1;
+	  }
+	else
+	  top = *--sp;
+	break;
+      case PLURAL_OP_POP_JUMP_IF_ZERO:
+	right = top;
+	top = *--sp;
+	if (right == 0)
+	  pc = prog->insns + pc->arg - 1;
+	break;
+      case PLURAL_OP_JUMP:
+	pc = prog->insns + pc->arg - 1;
+	break;
+      case PLURAL_OP_RETURN:
+	return top;
+      }
+}
@@ -50,6 +50,9 @@
 /* List of already loaded domains.  */
 static struct loaded_l10nfile *_nl_loaded_domains;
 
+/* We need to protect modifying the _NL_LOADED_DOMAINS data.  */
+gl_rwlock_define_initialized (static, loaded_domains_lock)
+
 
 /* Return a data structure describing the message catalog described by
    the DOMAINNAME and CATEGORY parameters with respect to the currently
@@ -68,6 +71,8 @@ _nl_find_domain (const char *dirname, char *locale,
   const char *alias_value;
   int mask;
 
+  DOMAIN_STATS_COUNT_FILE (domainname, catalog_searches);
+
   /* LOCALE can consist of up to four recognized parts for the XPG syntax:
 
 		language[_territory][.codeset][@modifier]
@@ -82,9 +87,7 @@ _nl_find_domain (const char *dirname, char *locale,
 		(4) modifier
    */
 
-  /* We need to protect modifying the _NL_LOADED_DOMAINS data.  */
-  gl_rwlock_define_initialized (static, lock);
-  gl_rwlock_rdlock (lock);
+  gl_rwlock_rdlock (loaded_domains_lock);
 
   /* If we have already tested for this locale entry there has to
      be one data set in the list of loaded domains.  */
@@ -92,7 +95,7 @@ _nl_find_domain (const char *dirname, char *locale,
 			       strlen (dirname) + 1, 0, locale, NULL, NULL,
 			       NULL, NULL, domainname, 0);
 
-  gl_rwlock_unlock (lock);
+  gl_rwlock_unlock (loaded_domains_lock);
 
   if (retval != NULL)
     {
@@ -147,7 +150,7 @@ _nl_find_domain (const char *dirname, char *locale,
     return NULL;
 
   /* We need to protect modifying the _NL_LOADED_DOMAINS data.  */
-  gl_rwlock_wrlock (lock);
+  gl_rwlock_wrlock (loaded_domains_lock);
 
   /* Create all possible locale entries which might be interested in
      generalization.  */
@@ -156,7 +159,7 @@ _nl_find_domain (const char *dirname, char *locale,
 			       codeset, normalized_codeset, modifier,
 			       domainname, 1);
 
-  gl_rwlock_unlock (lock);
+  gl_rwlock_unlock (loaded_domains_lock);
 
   if (retval == NULL)
     /* This means we are out of core.  */
@@ -189,6 +192,62 @@ out:
 }
 
 
+#ifndef _LIBC
+/* Store the memory usage of up to N loaded message catalogs in STATSP[0],
+   STATSP[1], ...  Return the number of loaded message catalogs.  */
+size_t
+libintl_get_catalog_stats (struct libintl_catalog_stats *statsp, size_t n)
+{
+  struct loaded_l10nfile *runp;
+  size_t count = 0;
+
+  gl_rwlock_rdlock (loaded_domains_lock);
+
+  for (runp = _nl_loaded_domains; runp != NULL; runp = runp->next)
+    if (runp->decided > 0 && runp->data != NULL)
+      {
+	if (count < n)
+	  _nl_get_catalog_stats (runp, &statsp[count]);
+	count++;
+      }
+
+  gl_rwlock_unlock (loaded_domains_lock);
+
+  return count;
+}
+
+/* Read the loaded message catalogs of DOMAINNAME again whose files have
+   changed.  Return the number of catalogs that were reloaded.  */
+int
+internal_function
+_nl_reload_domains (const char *domainname, struct binding *domainbinding)
+{
+  size_t domainname_len = strlen (domainname);
+  struct loaded_l10nfile *runp;
+  int count = 0;
+
+  gl_rwlock_rdlock (loaded_domains_lock);
+
+  for (runp = _nl_loaded_domains; runp != NULL; runp = runp->next)
+    if (runp->decided > 0 && runp->data != NULL && runp->filename != NULL)
+      {
+	/* The file name ends in "/DOMAINNAME.mo".  */
+	size_t len = strlen (runp->filename);
+
+	if (len > domainname_len + 4
+	    && runp->filename[len - domainname_len - 4] == '/'
+	    && memcmp (runp->filename + len - domainname_len - 3,
+		       domainname, domainname_len) == 0
+	    && strcmp (runp->filename + len - 3, ".mo") == 0)
+	  count += _nl_reload_domain (runp, domainbinding);
+      }
+
+  gl_rwlock_unlock (loaded_domains_lock);
+
+  return count;
+}
+#endif
+
 #ifdef _LIBC
 /* This is called from iconv/gconv_db.c's free_mem, as locales must
    be freed before freeing gconv steps arrays.  */
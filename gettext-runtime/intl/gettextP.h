@@ -19,6 +19,8 @@
 #define _GETTEXTP_H
 
 #include <stddef.h>		/* Get size_t.  */
+#include <sys/types.h>		/* Get dev_t, ino_t.  */
+#include <time.h>		/* Get time_t.  */
 
 #ifdef _LIBC
 # include "../iconv/gconv_int.h"
@@ -59,6 +61,7 @@ extern char *__bindtextdomain (const char *__domainname,
 extern char *__bind_textdomain_codeset (const char *__domainname,
 					const char *__codeset);
 extern void _nl_finddomain_subfreeres (void) attribute_hidden;
+extern void _nl_textdomain_subfreeres (void) attribute_hidden;
 extern void _nl_unload_domain (struct loaded_domain *__domain)
      internal_function attribute_hidden;
 #else
@@ -106,6 +109,35 @@ extern char *libintl_dcigettext (const char *__domainname,
 # define W(flag, data) ((flag) ? SWAP (data) : (data))
 #endif
 
+/* Support for data structures that are read without taking a lock.
+   Writers still serialize among themselves, but publish their updates
+   with release semantics, so that readers which load with acquire
+   semantics never see a partially initialized object.  When the compiler
+   does not provide the necessary primitives, readers take the lock.  */
+#if (defined __GNUC__ \
+     && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))) \
+    || defined __clang__
+# define HAVE_LOCKFREE_READERS 1
+# define ATOMIC_LOAD_ACQUIRE(var) __atomic_load_n (&(var), __ATOMIC_ACQUIRE)
+# define ATOMIC_LOAD_RELAXED(var) __atomic_load_n (&(var), __ATOMIC_RELAXED)
+# define ATOMIC_STORE_RELEASE(var, value) \
+    __atomic_store_n (&(var), (value), __ATOMIC_RELEASE)
+# define ATOMIC_STORE_RELAXED(var, value) \
+    __atomic_store_n (&(var), (value), __ATOMIC_RELAXED)
+# define ATOMIC_INCREMENT_RELAXED(var) \
+    __atomic_add_fetch (&(var), 1, __ATOMIC_RELAXED)
+# define ATOMIC_FENCE_ACQUIRE() __atomic_thread_fence (__ATOMIC_ACQUIRE)
+# define ATOMIC_FENCE_RELEASE() __atomic_thread_fence (__ATOMIC_RELEASE)
+#else
+# define ATOMIC_LOAD_ACQUIRE(var) (var)
+# define ATOMIC_LOAD_RELAXED(var) (var)
+# define ATOMIC_STORE_RELEASE(var, value) ((var) = (value))
+# define ATOMIC_STORE_RELAXED(var, value) ((var) = (value))
+# define ATOMIC_INCREMENT_RELAXED(var) (++(var))
+# define ATOMIC_FENCE_ACQUIRE()
+# define ATOMIC_FENCE_RELEASE()
+#endif
+
 
 #ifdef _LIBC
 # include <byteswap.h>
@@ -135,7 +167,7 @@ struct sysdep_string_desc
 
 /* Cache of translated strings after charset conversion.
    Note: The strings are converted to the target encoding only on an as-needed
-   basis.  */
+   basis, unless eager conversion is enabled.  */
 struct converted_domain
 {
   /* The target encoding name.  */
@@ -151,8 +183,24 @@ struct converted_domain
 #endif
   /* The table of translated strings after charset conversion.  */
   char **conv_tab;
+  /* The memory from which the converted strings are allocated one at a
+     time, and its size.  */
+  unsigned char *freemem;
+  size_t freemem_size;
+  /* The memory holding all converted strings, when they were converted
+     at once, or NULL.  */
+  char *conv_mem;
+  /* This lock protects conv, write accesses to conv_tab, and freemem.
+     Each conversion has its own, so that threads that convert strings of
+     different catalogs, or to different encodings, don't wait for each
+     other.  */
+  __libc_lock_define (, lock)
 };
 
+/* Number of small values of n whose plural form index is remembered.  */
+#define PLURAL_INDICES_SIZE 256
+#define PLURAL_INDEX_UNKNOWN 0xff
+
 /* The representation of an opened message catalog.  */
 struct loaded_domain
 {
@@ -160,6 +208,8 @@ struct loaded_domain
   const char *data;
   /* 1 if the memory is mmap()ed, 0 if the memory is malloc()ed.  */
   int use_mmap;
+  /* 1 if the memory is part of a bundle, and not owned by this catalog.  */
+  int in_bundle;
   /* Size of mmap()ed memory.  */
   size_t mmap_size;
   /* 1 if the .mo file uses a different endianness than this machine.  */
@@ -185,16 +235,44 @@ struct loaded_domain
   nls_uint32 hash_size;
   /* Pointer to hash table.  */
   const nls_uint32 *hash_tab;
-  /* 1 if the hash table uses a different endianness than this machine.  */
+  /* 1 if the hash tables use a different endianness than this machine.  */
   int must_swap_hash_tab;
-
-  /* Cache of charset conversions of the translated strings.  */
-  struct converted_domain *conversions;
+  /* Number of entries of the secondary hash table, a power of 2, or 0.
+     It is keyed by __hash_string_murmur3 and uses linear probing.  */
+  nls_uint32 hash2_size;
+  /* Pointer to the secondary hash table, or NULL.  Its entries are 2 words
+     wide, see MO_HASH_FUNCTION_MURMUR3_WITH_FINGERPRINTS.  */
+  const nls_uint32 *hash2_tab;
+
+  /* Cache of charset conversions of the translated strings.  The elements
+     are allocated one by one, so that they stay in place when the array
+     grows.  */
+  struct converted_domain **conversions;
   size_t nconversions;
   gl_rwlock_define (, conversions_lock)
 
   const struct expression *plural;
   unsigned long int nplurals;
+  /* PLURAL prepared for fast evaluation, or NULL.  */
+  const struct plural_program *plural_program;
+  /* 1 if PLURAL and PLURAL_PROGRAM are shared with other catalogs.  */
+  int plural_shared;
+  /* Plural form indices for the values of n below PLURAL_INDICES_SIZE,
+     filled as they are evaluated.  PLURAL_INDEX_UNKNOWN marks the values
+     that have not been evaluated yet.  */
+  unsigned char plural_indices[PLURAL_INDICES_SIZE];
+
+#ifndef _LIBC
+  /* Identification of the file at the time it was read, so that a reload
+     can tell whether it has changed.  All zero if IN_BUNDLE.  */
+  dev_t dev;
+  ino_t ino;
+  time_t mtime;
+  /* The contents that this catalog had before it was loaded again, or
+     NULL.  They are kept, because the translations that were looked up in
+     them may still be in use.  */
+  const struct loaded_domain *previous;
+#endif
 };
 
 /* We want to allocate a string at the end of the struct.  But ISO C
@@ -206,12 +284,16 @@ struct loaded_domain
 #endif
 
 /* A set of settings bound to a message domain.  Used to store settings
-   from bindtextdomain() and bind_textdomain_codeset().  */
+   from bindtextdomain(), bind_textdomain_codeset() and
+   libintl_bind_textdomain_layers().  */
 struct binding
 {
   struct binding *next;
   char *dirname;
   char *codeset;
+  /* NULL, or the NULL terminated list of domains in which the messages
+     of this domain are looked up.  */
+  char **layers;
   char domainname[ZERO];
 };
 
@@ -259,17 +341,33 @@ struct loaded_l10nfile *_nl_find_domain (const char *__dirname, char *__locale,
 void _nl_load_domain (struct loaded_l10nfile *__domain,
 		      struct binding *__domainbinding)
      internal_function;
+void _nl_advise_domain (struct loaded_l10nfile *__domain)
+     internal_function;
+#ifndef _LIBC
+int _nl_running_secure (void)
+     internal_function;
+int _nl_reload_domain (struct loaded_l10nfile *__domain,
+		       struct binding *__domainbinding)
+     internal_function;
+int _nl_reload_domains (const char *__domainname,
+			struct binding *__domainbinding)
+     internal_function;
+struct libintl_catalog_stats;
+void _nl_get_catalog_stats (const struct loaded_l10nfile *__domain,
+			    struct libintl_catalog_stats *__statsp)
+     internal_function;
+#endif
 
 #ifdef IN_LIBGLOCALE
 char *_nl_find_msg (struct loaded_l10nfile *domain_file,
 		    struct binding *domainbinding, const char *encoding,
 		    const char *msgid,
-		    size_t *lengthp)
+		    size_t *lengthp, const char **msgidp)
      internal_function;
 #else
 char *_nl_find_msg (struct loaded_l10nfile *domain_file,
 		    struct binding *domainbinding, const char *msgid,
-		    int convert, size_t *lengthp)
+		    int convert, size_t *lengthp, const char **msgidp)
      internal_function;
 #endif
 
@@ -304,6 +402,65 @@ extern const char _nl_default_default_domain[] attribute_hidden;
 /* Default text domain in which entries for gettext(3) are to be found.  */
 extern const char *_nl_current_default_domain attribute_hidden;
 
+#if !defined _LIBC && !defined IN_LIBGLOCALE
+/* Counters of the lookups in a message domain.  */
+struct domain_stats
+{
+  struct domain_stats *next;
+  /* Number of translations found among the known translations.  */
+  unsigned long int cache_hits;
+  /* Number of messages looked up in the message catalogs.  */
+  unsigned long int catalog_lookups;
+  /* Number of messages returned untranslated.  */
+  unsigned long int untranslated;
+  /* Number of translations converted to the output charset.  */
+  unsigned long int conversions;
+  /* Number of searches for the message catalog of a locale.  */
+  unsigned long int catalog_searches;
+  /* Number of message catalog files loaded, and of those not found.  */
+  unsigned long int catalogs_loaded;
+  unsigned long int catalogs_missing;
+  char domainname[ZERO];
+};
+
+# define _nl_domain_stats_enabled libintl_nl_domain_stats_enabled
+
+/* Nonzero if the lookups are counted, or -1 if not yet known.  */
+extern int _nl_domain_stats_enabled attribute_hidden;
+
+struct domain_stats *_nl_find_domain_stats (const char *__domainname,
+					    size_t __len)
+     internal_function;
+struct domain_stats *_nl_find_file_domain_stats (const char *__filename)
+     internal_function;
+
+/* Increment the counter FIELD of the lookups in the domain whose name is
+   the LEN bytes at DOMAINNAME, if the lookups are counted.  */
+# define DOMAIN_STATS_COUNT(domainname, len, field) \
+  do									      \
+    if (__builtin_expect (ATOMIC_LOAD_RELAXED (_nl_domain_stats_enabled), 0))\
+      {									      \
+	struct domain_stats *stats_ = _nl_find_domain_stats (domainname, len);\
+	if (stats_ != NULL)						      \
+	  ATOMIC_INCREMENT_RELAXED (stats_->field);			      \
+      }									      \
+  while (0)
+
+/* Likewise for the domain of the message catalog file FILENAME.  */
+# define DOMAIN_STATS_COUNT_FILE(filename, field) \
+  do									      \
+    if (__builtin_expect (ATOMIC_LOAD_RELAXED (_nl_domain_stats_enabled), 0))\
+      {									      \
+	struct domain_stats *stats_ = _nl_find_file_domain_stats (filename);  \
+	if (stats_ != NULL)						      \
+	  ATOMIC_INCREMENT_RELAXED (stats_->field);			      \
+      }									      \
+  while (0)
+#else
+# define DOMAIN_STATS_COUNT(domainname, len, field)
+# define DOMAIN_STATS_COUNT_FILE(filename, field)
+#endif
+
 /* @@ begin of epilog @@ */
 
 #endif /* gettextP.h  */
@@ -29,6 +29,18 @@
 #define MO_REVISION_NUMBER 0
 #define MO_REVISION_NUMBER_WITH_SYSDEP_I 1
 
+/* Identifiers of the hash functions that can have built the secondary
+   hash table of .mo files with minor revision >= 2, and of the layout of
+   its entries.  The primary hash table is always built with hashpjw.
+   The value 1 is reserved; readers treat it like an unknown value.  */
+/* Each entry is a pair of 32-bit words: a string index + 1, or 0 for an
+   empty entry, followed by the full hash value of that string, as a
+   fingerprint.  An entry whose fingerprint differs from the hash value of
+   the looked up string can be skipped without looking at the string.  But
+   equal fingerprints don't imply equal strings, nor equal lengths: the
+   string must still be compared.  */
+#define MO_HASH_FUNCTION_MURMUR3_WITH_FINGERPRINTS 2
+
 /* The following contortions are an attempt to use the C preprocessor
    to determine an unsigned integral type that is 32 bits wide.  An
    alternative approach is to use autoconf's AC_CHECK_SIZEOF macro, but
@@ -100,6 +112,16 @@ struct mo_file_header
   nls_uint32 orig_sysdep_tab_offset;
   /* Offset of table with start offsets of translated sysdep strings.  */
   nls_uint32 trans_sysdep_tab_offset;
+
+  /* The following are only used in .mo files with minor revision >= 2.  */
+
+  /* Identifier of the hash function of the secondary hash table,
+     one of the MO_HASH_FUNCTION_* values.  */
+  nls_uint32 hash2_function;
+  /* Number of entries of secondary hash table, a power of 2, or 0.  */
+  nls_uint32 hash2_tab_size;
+  /* Offset of first secondary hash table entry.  */
+  nls_uint32 hash2_tab_offset;
 };
 
 /* Descriptor for static string contained in the binary .mo file.  */
@@ -145,6 +167,85 @@ struct sysdep_string
    regardless whether 'int' is 16 bit, 32 bit, or 64 bit.  */
 #define SEGMENTS_END ((nls_uint32) ~0)
 
+
+/* A bundle holds the contents of many .mo files below a locale directory,
+   so that all of them can be loaded with a single open() and mmap().  */
+
+/* The magic number of the bundle format.  */
+#define _MAGIC_BUNDLE 0x950412df
+#define _MAGIC_BUNDLE_SWAPPED 0xdf120495
+
+/* Revision number of the bundle format.  */
+#define BUNDLE_REVISION_NUMBER 0
+
+/* Name of the bundle in a locale directory.  */
+#define BUNDLE_FILENAME "catalogs.bundle"
+
+/* Header of a bundle.  */
+struct bundle_header
+{
+  /* The magic number.  */
+  nls_uint32 magic;
+  /* The revision number of the file format.  */
+  nls_uint32 revision;
+  /* The number of .mo files.  */
+  nls_uint32 nentries;
+  /* Offset of table of struct bundle_entry, sorted by name.  */
+  nls_uint32 entries_offset;
+};
+
+/* Descriptor for a .mo file contained in a bundle.  */
+struct bundle_entry
+{
+  /* Length of the file name relative to the locale directory, such as
+     "de/LC_MESSAGES/domain.mo", not including the trailing NUL.  */
+  nls_uint32 name_length;
+  /* Offset of the file name in the bundle.  */
+  nls_uint32 name_offset;
+  /* Size of the .mo file.  */
+  nls_uint32 data_length;
+  /* Offset of the contents of the .mo file in the bundle, a multiple of 8.
+     The offsets within the .mo file are relative to it.  */
+  nls_uint32 data_offset;
+};
+
+
+/* An alias index holds the aliases of a locale.alias file, sorted, so that
+   they can be looked up without parsing the file.  */
+
+/* The magic number of the alias index format.  */
+#define _MAGIC_ALIAS 0x950412e0
+#define _MAGIC_ALIAS_SWAPPED 0xe0120495
+
+/* Revision number of the alias index format.  */
+#define ALIAS_REVISION_NUMBER 0
+
+/* Name of the alias index, next to the locale.alias file.  */
+#define ALIAS_INDEX_FILENAME "locale.alias.idx"
+
+/* Header of an alias index.  */
+struct alias_index_header
+{
+  /* The magic number.  */
+  nls_uint32 magic;
+  /* The revision number of the file format.  */
+  nls_uint32 revision;
+  /* The number of aliases.  */
+  nls_uint32 nentries;
+  /* Offset of table of struct alias_index_entry, sorted by alias, with
+     the ASCII letters compared case-insensitively.  */
+  nls_uint32 entries_offset;
+};
+
+/* Descriptor for an alias.  */
+struct alias_index_entry
+{
+  /* Offset of the NUL terminated alias in the file.  */
+  nls_uint32 alias_offset;
+  /* Offset of the NUL terminated locale name it stands for.  */
+  nls_uint32 value_offset;
+};
+
 /* @@ begin of epilog @@ */
 
 #endif	/* gettext.h  */
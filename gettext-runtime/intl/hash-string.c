@@ -48,3 +48,64 @@ __hash_string (const char *str_param)
     }
   return hval;
 }
+
+
+/* Rotate the 32-bit value X left by N bits.  */
+#define ROTL32(x, n) \
+  ((((x) << (n)) | (((x) & 0xffffffffUL) >> (32 - (n)))) & 0xffffffffUL)
+
+/* Defines the 32-bit variant of Austin Appleby's MurmurHash3, with seed 0.
+   Unlike hashpjw, it consumes a whole 32-bit word per iteration, without
+   data dependent branches, and mixes every input bit into the whole hash
+   value, so that long strings sharing a common prefix are well spread.  */
+unsigned long int
+__hash_string_murmur3 (const char *str, size_t len)
+{
+  const unsigned char *p = (const unsigned char *) str;
+  const unsigned char *words_end = p + (len & ~(size_t) 3);
+  unsigned long int hval, k;
+
+  hval = 0;
+  /* Compilers turn this byte assembly into a single load on little-endian
+     machines that allow unaligned accesses.  */
+  for (; p < words_end; p += 4)
+    {
+      k = (unsigned long int) p[0]
+	  | ((unsigned long int) p[1] << 8)
+	  | ((unsigned long int) p[2] << 16)
+	  | ((unsigned long int) p[3] << 24);
+      k = (k * 0xcc9e2d51UL) & 0xffffffffUL;
+      k = ROTL32 (k, 15);
+      k = (k * 0x1b873593UL) & 0xffffffffUL;
+      hval ^= k;
+      hval = ROTL32 (hval, 13);
+      hval = (hval * 5 + 0xe6546b64UL) & 0xffffffffUL;
+    }
+
+  /* The remaining 0 to 3 bytes.  */
+  k = 0;
+  switch (len & 3)
+    {
+    case 3:
+      k ^= (unsigned long int) p[2] << 16;
+      /* FALLTHROUGH */
+    case 2:
+      k ^= (unsigned long int) p[1] << 8;
+      /* FALLTHROUGH */
+    case 1:
+      k ^= (unsigned long int) p[0];
+      k = (k * 0xcc9e2d51UL) & 0xffffffffUL;
+      k = ROTL32 (k, 15);
+      k = (k * 0x1b873593UL) & 0xffffffffUL;
+      hval ^= k;
+    }
+
+  /* Final avalanche.  */
+  hval ^= (unsigned long int) len & 0xffffffffUL;
+  hval ^= hval >> 16;
+  hval = (hval * 0x85ebca6bUL) & 0xffffffffUL;
+  hval ^= hval >> 13;
+  hval = (hval * 0xc2b2ae35UL) & 0xffffffffUL;
+  hval ^= hval >> 16;
+  return hval;
+}
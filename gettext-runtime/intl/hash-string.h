@@ -14,6 +14,8 @@
    You should have received a copy of the GNU Lesser General Public License
    along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
 
+#include <stddef.h>
+
 /* @@ end of prolog @@ */
 
 /* We assume to have `unsigned long int' value with at least 32 bits.  */
@@ -23,8 +25,10 @@
 #ifndef _LIBC
 # ifdef IN_LIBINTL
 #  define __hash_string libintl_hash_string
+#  define __hash_string_murmur3 libintl_hash_string_murmur3
 # else
 #  define __hash_string hash_string
+#  define __hash_string_murmur3 hash_string_murmur3
 # endif
 #endif
 
@@ -32,3 +36,9 @@
    [see Aho/Sethi/Ullman, COMPILERS: Principles, Techniques and Tools,
    1986, 1987 Bell Telephone Laboratories, Inc.]  */
 extern unsigned long int __hash_string (const char *str_param);
+
+/* Defines the 32-bit variant of Austin Appleby's MurmurHash3, with seed 0,
+   over the LEN bytes starting at STR.  The input is consumed four bytes at
+   a time, read in little-endian order regardless of the host, so that the
+   result can be stored in .mo files.  */
+extern unsigned long int __hash_string_murmur3 (const char *str, size_t len);
@@ -40,7 +40,7 @@
 /* Provide information about the supported file formats.  Returns the
    maximum minor revision number supported for a given major revision.  */
 #define __GNU_GETTEXT_SUPPORTED_REVISION(major) \
-  ((major) == 0 || (major) == 1 ? 1 : -1)
+  ((major) == 0 || (major) == 1 ? 2 : -1)
 
 /* Resolve a platform specific conflict on DJGPP.  GNU gettext takes
    precedence over _conio_gettext.  */
@@ -446,6 +446,309 @@ extern locale_t newlocale (int, const char *, locale_t);
 #endif
 
 
+/* Support for layered domains.  */
+
+/* Declares that the messages of DOMAINNAME are to be looked up in the
+   domains LAYERS[0], LAYERS[1], ..., in this order, until a translation is
+   found.  LAYERS is terminated by a NULL pointer.  Each layer uses its own
+   bindtextdomain() and bind_textdomain_codeset() settings.  The layers of a
+   layer are not consulted.  An empty list turns DOMAINNAME back into an
+   ordinary domain.  Returns 0 upon success, or -1 if memory was
+   exhausted.  */
+#define libintl_bind_textdomain_layers libintl_bind_textdomain_layers
+extern int libintl_bind_textdomain_layers (const char *__domainname,
+                                           const char * const *__layers);
+
+
+/* Support for loading message catalogs ahead of time.  */
+
+/* Loads the message catalogs of DOMAINNAME, or of the current default
+   domain if DOMAINNAME is NULL, for the LC_MESSAGES category and each of
+   the LOCALES, and prepares them for lookups, so that the first gettext()
+   call does not have to wait for them.  LOCALES is terminated by a NULL
+   pointer; each of its elements may be a colon-separated list of locale
+   names, like the value of the LANGUAGE environment variable.  If LOCALES
+   is NULL, the locales that gettext() would currently consult are used.
+   If DIRNAME is not NULL, it is first bound to DOMAINNAME, like
+   bindtextdomain() does.  For a layered domain, the catalogs of all its
+   layers are loaded.  Returns the number of catalogs found, or -1 if
+   memory was exhausted.  */
+#define libintl_textdomain_preload libintl_textdomain_preload
+extern int libintl_textdomain_preload (const char *__domainname,
+                                       const char *__dirname,
+                                       const char * const *__locales);
+
+
+/* Support for updating message catalogs while the program runs.  */
+
+/* Reads those loaded message catalogs of DOMAINNAME, or of the current
+   default domain if DOMAINNAME is NULL, again whose files have changed
+   since they were loaded, for example because a new version was installed.
+   Lookups in other threads see either the old or the new catalog, and the
+   translations that were looked up in other domains remain cached.  The
+   old catalog stays in memory, because the translations that gettext()
+   returned from it may still be in use.  A program that watches the
+   catalog files, for example with inotify, calls this function when they
+   change.  Returns the number of catalogs that were reloaded.  */
+#define libintl_reload_domain libintl_reload_domain
+extern int libintl_reload_domain (const char *__domainname);
+
+
+/* Support for translation contexts.  */
+
+/* A translation context looks up messages for a fixed list of locales.  It
+   remembers the message catalogs it has found for each domain, so that
+   later lookups in the same domain neither determine the current locale
+   nor take the locks of gettext().  A context may be used by several
+   threads at the same time.  */
+struct libintl_context;
+
+/* Creates a translation context for LOCALES, a colon-separated list of
+   locale names, like the value of the LANGUAGE environment variable.  If
+   LOCALES is NULL, the locales that gettext() would currently consult for
+   the LC_MESSAGES category in the calling thread are used.  Returns NULL
+   if memory was exhausted.  */
+#define libintl_context_create libintl_context_create
+extern struct libintl_context *libintl_context_create (const char *__locales);
+
+/* Frees a translation context.  It must not be in use by other threads.  */
+#define libintl_context_free libintl_context_free
+extern void libintl_context_free (struct libintl_context *__context);
+
+/* Looks up MSGID in the DOMAINNAME message catalog for the locales of
+   CONTEXT, like dgettext() does.  The message catalogs are looked up again
+   after a call to textdomain() or bindtextdomain() changed them.  */
+#define libintl_context_dgettext libintl_context_dgettext
+extern char *libintl_context_dgettext (struct libintl_context *__context,
+                                       const char *__domainname,
+                                       const char *__msgid)
+       _INTL_MAY_RETURN_STRING_ARG (3);
+
+/* Looks up MSGID1 in the DOMAINNAME message catalog for the locales of
+   CONTEXT, like dngettext() does.  */
+#define libintl_context_dngettext libintl_context_dngettext
+extern char *libintl_context_dngettext (struct libintl_context *__context,
+                                        const char *__domainname,
+                                        const char *__msgid1,
+                                        const char *__msgid2,
+                                        unsigned long int __n)
+       _INTL_MAY_RETURN_STRING_ARG (3) _INTL_MAY_RETURN_STRING_ARG (4);
+
+
+/* Support for message catalog handles.  */
+
+/* A message catalog handle stands for the message catalogs of a domain, as
+   found once and for all for a list of locales and an output charset.  Its
+   lookups go straight to these catalogs.  A handle may be used by several
+   threads at the same time.  */
+struct libintl_catalog;
+
+/* Opens a handle for the message catalogs of DOMAINNAME, or of the current
+   default domain if DOMAINNAME is NULL, for the LC_MESSAGES category and
+   LOCALES, a colon-separated list of locale names, like the value of the
+   LANGUAGE environment variable.  If LOCALES is NULL, the locales that
+   gettext() would currently consult are used.  The translations are
+   returned in CODESET, or, if CODESET is NULL, in the encoding that
+   gettext() would use.  Later calls to bindtextdomain() and
+   bind_textdomain_codeset() do not affect the handle.  Returns NULL if
+   memory was exhausted.  */
+#define libintl_open_catalog libintl_open_catalog
+extern struct libintl_catalog *libintl_open_catalog (const char *__domainname,
+                                                     const char *__locales,
+                                                     const char *__codeset);
+
+/* Closes a message catalog handle.  It must not be in use by other
+   threads.  */
+#define libintl_close_catalog libintl_close_catalog
+extern void libintl_close_catalog (struct libintl_catalog *__catalog);
+
+/* Looks up MSGID in the message catalogs of CATALOG.  If not found, returns
+   MSGID itself.  */
+#define libintl_handle_gettext libintl_handle_gettext
+extern char *libintl_handle_gettext (struct libintl_catalog *__catalog,
+                                     const char *__msgid)
+       _INTL_MAY_RETURN_STRING_ARG (2);
+
+/* Similar to libintl_handle_gettext but select the plural form
+   corresponding to the number N.  */
+#define libintl_handle_ngettext libintl_handle_ngettext
+extern char *libintl_handle_ngettext (struct libintl_catalog *__catalog,
+                                      const char *__msgid1,
+                                      const char *__msgid2,
+                                      unsigned long int __n)
+       _INTL_MAY_RETURN_STRING_ARG (2) _INTL_MAY_RETURN_STRING_ARG (3);
+
+
+/* Support for looking up many messages at once.  */
+
+#include <stddef.h>
+
+/* A message to look up with libintl_dcgettext_batch.  */
+struct libintl_batch_message
+{
+  /* The context of the message, like the first argument of pgettext(), or
+     NULL.  */
+  const char *msgctxt;
+  /* The message.  */
+  const char *msgid;
+  /* The plural form of the message, or NULL if the message has no plural
+     form.  */
+  const char *msgid_plural;
+  /* The number that selects the plural form.  */
+  unsigned long int n;
+  /* Set to the translation, or to MSGID or MSGID_PLURAL if there is
+     none.  */
+  const char *translation;
+};
+
+/* Looks up the COUNT messages at MESSAGES in the DOMAINNAME message catalog
+   for the current CATEGORY locale, like dcgettext(), dcngettext() and
+   pgettext() would, and stores their translations in MESSAGES.  The message
+   catalogs are found only once for all messages, and are kept for the next
+   calls, each message is hashed only once, and the lookups of the next
+   messages are prepared while a message is looked up.  Returns the number
+   of messages that have a translation.  */
+#define libintl_dcgettext_batch libintl_dcgettext_batch
+extern size_t
+       libintl_dcgettext_batch (const char *__domainname,
+                                struct libintl_batch_message *__messages,
+                                size_t __count, int __category);
+
+
+/* Support for controlling how message catalogs are mapped into memory.  */
+
+#include <stddef.h>
+
+/* Flags for libintl_set_mmap_policy.  */
+/* Prefault the pages of a catalog when it is mapped.  */
+#define LIBINTL_MMAP_POPULATE 1
+/* Ask the kernel to read in the pages of a catalog when it is mapped.  */
+#define LIBINTL_MMAP_WILLNEED 2
+/* Tell the kernel that the pages of a catalog are accessed in random
+   order, so that it does not read ahead.  */
+#define LIBINTL_MMAP_RANDOM 4
+/* Ask the kernel to back the catalogs with huge pages where possible.  */
+#define LIBINTL_MMAP_HUGEPAGE 8
+/* Read the catalogs into allocated memory instead of mapping them.  */
+#define LIBINTL_MMAP_READ 16
+
+/* Sets the policy for mapping the message catalogs that are loaded from now
+   on, as a combination of the LIBINTL_MMAP_* flags.  By default, the policy
+   is taken from the GETTEXT_MMAP_POLICY environment variable, a
+   comma-separated list among "populate", "willneed", "random", "hugepage"
+   and "read", except in SUID and SGID programs.  Flags that the system
+   does not support are ignored.  */
+#define libintl_set_mmap_policy libintl_set_mmap_policy
+extern void libintl_set_mmap_policy (int __policy);
+
+/* Memory usage of a loaded message catalog.  */
+struct libintl_catalog_stats
+{
+  /* File name of the catalog.  */
+  const char *filename;
+  /* Number of bytes of the file that are mapped into memory.  */
+  size_t mapped_bytes;
+  /* Number of bytes of the file that were read into allocated memory,
+     because the file could not be mapped or LIBINTL_MMAP_READ was set.  */
+  size_t read_bytes;
+  /* Number of the mapped pages that are resident in memory, or
+     (size_t)(-1) if unknown.  */
+  size_t resident_pages;
+};
+
+/* Stores the memory usage of up to N loaded message catalogs in STATSP[0],
+   STATSP[1], ...  Returns the number of loaded message catalogs, which may
+   be larger than N.  */
+#define libintl_get_catalog_stats libintl_get_catalog_stats
+extern size_t
+       libintl_get_catalog_stats (struct libintl_catalog_stats *__statsp,
+                                  size_t __n);
+
+/* Support for converting translations ahead of time.  */
+
+/* Sets whether the translations of a message catalog are all converted at
+   once, into a single block of memory, when they are first needed in an
+   encoding other than the catalog's, instead of one at a time when they
+   are looked up.  This makes the first lookup slower and the later ones
+   faster.  It applies to the encodings that are first needed from now on.
+   By default, this is enabled if the GETTEXT_EAGER_CONVERSION environment
+   variable is set to a value other than "0".  */
+#define libintl_set_eager_conversion libintl_set_eager_conversion
+extern void libintl_set_eager_conversion (int __enable);
+
+
+/* Support for tuning the cache of translations that gettext() and its
+   variants have already looked up.  */
+
+/* Statistics about the cache of looked up translations.  */
+struct libintl_cache_stats
+{
+  /* Number of lookups that were answered from the cache.  Only counted
+     after libintl_count_cache_hits (1) was called.  */
+  unsigned long int hits;
+  /* Number of lookups that were not answered from the cache.  Only
+     counted after libintl_count_cache_hits (1) was called.  */
+  unsigned long int misses;
+  /* Number of entries that were dropped from the cache because it was
+     full.  */
+  unsigned long int evictions;
+  /* Number of entries currently in the cache.  */
+  size_t entries;
+  /* Maximum number of entries in the cache.  */
+  size_t capacity;
+};
+
+/* Sets the maximum number of entries in the cache.  The value is rounded
+   up to a power of 2.  0 means the default.  */
+#define libintl_set_cache_capacity libintl_set_cache_capacity
+extern void libintl_set_cache_capacity (size_t capacity);
+
+/* Enables or disables the counting of cache hits and misses.  It is
+   disabled by default, because it slows down gettext() in multithreaded
+   programs.  */
+#define libintl_count_cache_hits libintl_count_cache_hits
+extern void libintl_count_cache_hits (int enable);
+
+/* Stores statistics about the cache in *STATSP.  */
+#define libintl_get_cache_stats libintl_get_cache_stats
+extern void libintl_get_cache_stats (struct libintl_cache_stats *statsp);
+
+/* Counters of the lookups in a message domain by gettext() and its
+   variants, the translation contexts, the catalog handles and
+   libintl_dcgettext_batch.  */
+struct libintl_domain_stats
+{
+  /* The domain name.  */
+  const char *domainname;
+  /* Number of translations that were found in the cache.  */
+  unsigned long int cache_hits;
+  /* Number of messages that were looked up in the message catalogs.  */
+  unsigned long int catalog_lookups;
+  /* Number of messages that were returned untranslated.  */
+  unsigned long int untranslated;
+  /* Number of translations that were converted to the output charset.  */
+  unsigned long int conversions;
+  /* Number of searches for the message catalog of a locale.  */
+  unsigned long int catalog_searches;
+  /* Number of message catalog files that were loaded.  */
+  unsigned long int catalogs_loaded;
+  /* Number of message catalog files that were looked for but not found.  */
+  unsigned long int catalogs_missing;
+};
+
+/* Enables or disables the counting of the lookups per domain.  It is
+   disabled by default, unless the environment variable GETTEXT_DOMAIN_STATS
+   is set; then the counters are appended at exit to the file it names.  */
+#define libintl_count_domain_stats libintl_count_domain_stats
+extern void libintl_count_domain_stats (int enable);
+
+/* Stores the counters of up to N domains in STATSP[0], STATSP[1], ...
+   Returns the number of domains that have counters.  */
+#define libintl_get_domain_stats libintl_get_domain_stats
+extern size_t libintl_get_domain_stats (struct libintl_domain_stats *statsp,
+                                        size_t n);
+
+
 /* Support for relocatable packages.  */
 
 /* Sets the original and the current installation prefix of the package.
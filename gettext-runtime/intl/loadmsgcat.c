@@ -57,6 +57,11 @@ char *alloca ();
 #include <stdlib.h>
 #include <string.h>
 
+#if !defined _LIBC && HAVE_DIRENT_H
+# include <dirent.h>
+# include <time.h>
+#endif
+
 #if defined HAVE_UNISTD_H || defined _LIBC
 # include <unistd.h>
 #endif
@@ -91,6 +96,9 @@ char *alloca ();
 # include "../locale/localeinfo.h"
 # include <not-cancel.h>
 #endif
+#ifndef _LIBC
+# include "libgnuintl.h"
+#endif
 
 /* Handle multi-threaded applications.  */
 #ifdef _LIBC
@@ -469,6 +477,7 @@ char *alloca ();
 # define mmap(addr, len, prot, flags, fd, offset) \
   __mmap (addr, len, prot, flags, fd, offset)
 # define munmap(addr, len)	__munmap (addr, len)
+# define madvise(addr, len, advice)	__madvise (addr, len, advice)
 #endif
 
 /* For those losing systems which don't have `alloca' we have to add
@@ -773,6 +782,730 @@ get_sysdep_segment_value (const char *name)
   return NULL;
 }
 
+#ifndef _LIBC
+/* The policy for mapping message catalogs into memory: a combination of
+   the LIBINTL_MMAP_* flags, or -1 if not yet determined.  */
+static int mmap_policy = -1;
+
+/* Names of the LIBINTL_MMAP_* flags in the GETTEXT_MMAP_POLICY environment
+   variable.  */
+static const struct
+{
+  char name[9];
+  int flag;
+} mmap_policy_names[] =
+{
+  { "populate", LIBINTL_MMAP_POPULATE },
+  { "willneed", LIBINTL_MMAP_WILLNEED },
+  { "random", LIBINTL_MMAP_RANDOM },
+  { "hugepage", LIBINTL_MMAP_HUGEPAGE },
+  { "read", LIBINTL_MMAP_READ }
+};
+
+/* Set the policy for mapping the message catalogs loaded from now on.  */
+void
+libintl_set_mmap_policy (int policy)
+{
+  ATOMIC_STORE_RELAXED (mmap_policy,
+			policy & (LIBINTL_MMAP_POPULATE | LIBINTL_MMAP_WILLNEED
+				  | LIBINTL_MMAP_RANDOM | LIBINTL_MMAP_HUGEPAGE
+				  | LIBINTL_MMAP_READ));
+}
+
+/* Return the policy for mapping message catalogs.  Unless it was set
+   through libintl_set_mmap_policy, it is taken from the comma-separated
+   list of flag names in the GETTEXT_MMAP_POLICY environment variable,
+   except in SUID and SGID programs.  */
+static int
+get_mmap_policy (void)
+{
+  int policy = ATOMIC_LOAD_RELAXED (mmap_policy);
+
+  if (policy < 0)
+    {
+      const char *value =
+	(_nl_running_secure () ? NULL : getenv ("GETTEXT_MMAP_POLICY"));
+
+      policy = 0;
+      if (value != NULL)
+	while (*value != '\0')
+	  {
+	    size_t len = strcspn (value, ", ");
+	    size_t i;
+
+	    for (i = 0;
+		 i < sizeof (mmap_policy_names) / sizeof (mmap_policy_names[0]);
+		 i++)
+	      if (strlen (mmap_policy_names[i].name) == len
+		  && memcmp (mmap_policy_names[i].name, value, len) == 0)
+		policy |= mmap_policy_names[i].flag;
+
+	    value += len;
+	    if (*value != '\0')
+	      value++;
+	  }
+      ATOMIC_STORE_RELAXED (mmap_policy, policy);
+    }
+
+  return policy;
+}
+#else
+/* In glibc, message catalogs are always mapped without further advice.  */
+# define get_mmap_policy() 0
+# define LIBINTL_MMAP_POPULATE 0
+# define LIBINTL_MMAP_WILLNEED 0
+# define LIBINTL_MMAP_RANDOM 0
+# define LIBINTL_MMAP_HUGEPAGE 0
+# define LIBINTL_MMAP_READ 0
+#endif
+
+/* Map or read the SIZE bytes of the file open on FD into memory, following
+   the mapping policy.  Set *USE_MMAPP to 1 if the memory is mmap()ed, to 0
+   if it is malloc()ed.  Return NULL upon failure.  */
+static void *
+load_file (int fd, size_t size, int *use_mmapp)
+{
+  int policy = get_mmap_policy ();
+  char *data;
+  size_t to_read;
+  char *read_ptr;
+
+#ifdef HAVE_MMAP
+  /* If mmap() is available we try this first.  If not available or it
+     failed we try to load the file.  */
+  if (!(policy & LIBINTL_MMAP_READ))
+    {
+      data = (char *) mmap (NULL, size, PROT_READ,
+			    MAP_PRIVATE
+# ifdef MAP_POPULATE
+			    | (policy & LIBINTL_MMAP_POPULATE ? MAP_POPULATE : 0)
+# endif
+			    , fd, 0);
+
+      if (__builtin_expect (data != (char *) -1, 1))
+	{
+	  /* mmap() call was successful.  */
+# if !defined _LIBC && defined HAVE_MADVISE
+	  /* Pass on the advice about the access pattern.  */
+#  ifdef MADV_WILLNEED
+	  if (policy & LIBINTL_MMAP_WILLNEED)
+	    madvise ((caddr_t) data, size, MADV_WILLNEED);
+#  endif
+#  ifdef MADV_RANDOM
+	  if (policy & LIBINTL_MMAP_RANDOM)
+	    madvise ((caddr_t) data, size, MADV_RANDOM);
+#  endif
+#  ifdef MADV_HUGEPAGE
+	  if (policy & LIBINTL_MMAP_HUGEPAGE)
+	    madvise ((caddr_t) data, size, MADV_HUGEPAGE);
+#  endif
+# endif
+	  *use_mmapp = 1;
+	  return data;
+	}
+    }
+#endif
+
+  /* The data is not mmap'ed, therefore we try to load it manually.  */
+  data = (char *) malloc (size);
+  if (data == NULL)
+    return NULL;
+
+  to_read = size;
+  read_ptr = data;
+  do
+    {
+      long int nb = (long int) read (fd, read_ptr, to_read);
+      if (nb <= 0)
+	{
+#ifdef EINTR
+	  if (nb == -1 && errno == EINTR)
+	    continue;
+#endif
+	  free (data);
+	  return NULL;
+	}
+      read_ptr += nb;
+      to_read -= nb;
+    }
+  while (to_read > 0);
+
+  *use_mmapp = 0;
+  return data;
+}
+
+/* Release the SIZE bytes of memory at DATA returned by load_file.  */
+static void
+unload_file (const char *data, size_t size, int use_mmap)
+{
+#ifdef HAVE_MMAP
+  if (use_mmap)
+    munmap ((caddr_t) data, size);
+  else
+#endif
+    free ((void *) data);
+}
+
+
+#if !defined _LIBC && HAVE_DIRENT_H && HAVE_OPENDIR
+/* The listing of a directory on the way to the message catalogs.  It lets
+   the catalogs that are not installed be found missing without trying to
+   open them.  */
+struct dir_listing
+{
+  struct dir_listing *next;
+  /* The directory.  */
+  const char *dirname;
+  size_t dirname_len;
+  /* 1 if the entries of the directory are known, 0 if it could not be
+     read, so that its entries have to be tried one by one.  */
+  int known;
+  /* The names of the entries, sorted.  None if the directory does not
+     exist.  */
+  char **names;
+  size_t nnames;
+  /* The modification time of the directory when it was read, or -1 if it
+     has to be read again.  */
+  time_t mtime;
+  /* The value of _nl_msg_cat_cntr when the modification time was last
+     compared.  */
+  int counter;
+};
+
+/* The directories listed so far.  Protected by the lock in
+   _nl_load_domain.  */
+static struct dir_listing *dir_listings;
+
+static int
+compare_names (const void *p1, const void *p2)
+{
+  return strcmp (*(const char * const *) p1, *(const char * const *) p2);
+}
+
+/* Forget the entries of LISTING.  */
+static void
+free_listing (struct dir_listing *listing)
+{
+  size_t i;
+
+  for (i = 0; i < listing->nnames; i++)
+    free (listing->names[i]);
+  free (listing->names);
+  listing->names = NULL;
+  listing->nnames = 0;
+  listing->known = 0;
+}
+
+/* Read the entries of the directory of LISTING, whose status is ST, or
+   NULL if it does not exist.  */
+static void
+read_listing (struct dir_listing *listing, const struct stat *st)
+{
+  DIR *dirp;
+  struct dirent *dp;
+  size_t allocated;
+
+  free_listing (listing);
+  listing->counter = _nl_msg_cat_cntr;
+  if (st == NULL)
+    {
+      /* A missing directory has no entries.  */
+      listing->mtime = 0;
+      listing->known = 1;
+      return;
+    }
+  listing->mtime = st->st_mtime;
+
+  dirp = opendir (listing->dirname);
+  if (dirp == NULL)
+    return;
+
+  allocated = 0;
+  while ((dp = readdir (dirp)) != NULL)
+    {
+      char *name;
+
+      if (dp->d_name[0] == '.')
+	continue;
+
+      if (listing->nnames == allocated)
+	{
+	  size_t new_allocated = 2 * allocated + 16;
+	  char **new_names =
+	    (char **) realloc (listing->names,
+			       new_allocated * sizeof (char *));
+
+	  if (new_names == NULL)
+	    goto fail;
+	  listing->names = new_names;
+	  allocated = new_allocated;
+	}
+
+      name = strdup (dp->d_name);
+      if (name == NULL)
+	goto fail;
+      listing->names[listing->nnames++] = name;
+    }
+  closedir (dirp);
+
+  qsort (listing->names, listing->nnames, sizeof (char *), compare_names);
+  listing->known = 1;
+  /* If the directory was modified within the last second, it may be
+     modified again without a visible change of its modification time.
+     Then read it again the next time.  */
+  if (listing->mtime >= time (NULL) - 1)
+    listing->mtime = (time_t) -1;
+  return;
+
+ fail:
+  closedir (dirp);
+  free_listing (listing);
+}
+
+/* Return 0 if the directory DIRNAME, of length DIRNAME_LEN, is known not
+   to contain an entry NAME, of length NAME_LEN, or 1 if it contains it or
+   may contain it.  */
+static int
+dir_may_contain (const char *dirname, size_t dirname_len,
+		 const char *name, size_t name_len)
+{
+  struct dir_listing *listing;
+  size_t bottom;
+  size_t top;
+
+  for (listing = dir_listings; listing != NULL; listing = listing->next)
+    if (listing->dirname_len == dirname_len
+	&& memcmp (listing->dirname, dirname, dirname_len) == 0)
+      break;
+
+  if (listing == NULL)
+    {
+      struct stat st;
+
+      listing = (struct dir_listing *)
+	malloc (sizeof (struct dir_listing) + dirname_len + 1);
+      if (listing == NULL)
+	return 1;
+      memcpy ((char *) (listing + 1), dirname, dirname_len);
+      ((char *) (listing + 1))[dirname_len] = '\0';
+      listing->dirname = (char *) (listing + 1);
+      listing->dirname_len = dirname_len;
+      listing->names = NULL;
+      listing->nnames = 0;
+      read_listing (listing, stat (listing->dirname, &st) == 0 ? &st : NULL);
+
+      listing->next = dir_listings;
+      dir_listings = listing;
+    }
+  else if (listing->counter != _nl_msg_cat_cntr)
+    {
+      /* The bindings changed since the directory was last looked at.  Read
+	 it again if it was modified meanwhile.  */
+      struct stat st;
+
+      if (stat (listing->dirname, &st) == 0)
+	{
+	  if (!listing->known || st.st_mtime != listing->mtime)
+	    read_listing (listing, &st);
+	  else
+	    listing->counter = _nl_msg_cat_cntr;
+	}
+      else
+	read_listing (listing, NULL);
+    }
+
+  if (!listing->known)
+    return 1;
+
+  /* The NAME_LEN bytes at NAME are not NUL terminated.  */
+  bottom = 0;
+  top = listing->nnames;
+  while (bottom < top)
+    {
+      size_t act = (bottom + top) / 2;
+      int cmp = strncmp (name, listing->names[act], name_len);
+
+      if (cmp == 0 && listing->names[act][name_len] != '\0')
+	cmp = -1;
+      if (cmp < 0)
+	top = act;
+      else if (cmp > 0)
+	bottom = act + 1;
+      else
+	return 1;
+    }
+  return 0;
+}
+
+/* Return 0 if the .mo file FILENAME, of the form
+   DIRNAME/LOCALE/CATEGORY/DOMAIN.mo, is known not to exist, or 1 if it
+   exists or may exist.  */
+static int
+catalog_may_exist (const char *filename)
+{
+  const char *slashes[3];
+  const char *p;
+  int n;
+  int i;
+
+  /* Find the last three slashes.  */
+  n = 0;
+  for (p = filename + strlen (filename); p > filename && n < 3; )
+    if (*--p == '/')
+      slashes[n++] = p;
+  if (n < 3 || slashes[2] == filename)
+    return 1;
+
+  /* Look for LOCALE in DIRNAME, CATEGORY in DIRNAME/LOCALE, and DOMAIN.mo
+     in DIRNAME/LOCALE/CATEGORY.  */
+  for (i = 2; i >= 0; i--)
+    {
+      const char *name = slashes[i] + 1;
+      const char *name_end = (i > 0 ? slashes[i - 1] : name + strlen (name));
+
+      if (!dir_may_contain (filename, slashes[i] - filename,
+			    name, name_end - name))
+	return 0;
+    }
+  return 1;
+}
+#else
+/* Without directory listings, all catalogs have to be tried.  */
+# define dir_may_contain(dirname, dirname_len, name, name_len) 1
+# define catalog_may_exist(filename) 1
+#endif
+
+/* A bundle of message catalogs in a locale directory, or the knowledge
+   that a locale directory has none.  */
+struct loaded_bundle
+{
+  struct loaded_bundle *next;
+  /* The locale directory.  */
+  const char *dirname;
+  size_t dirname_len;
+  /* The contents of the bundle, or NULL if the directory has none.  */
+  const char *data;
+  size_t size;
+  /* 1 if the memory is mmap()ed, 0 if the memory is malloc()ed.  */
+  int use_mmap;
+  /* 1 if the bundle uses a different endianness than this machine.  */
+  int must_swap;
+  /* The table of the .mo files in the bundle, sorted by name.  */
+  nls_uint32 nentries;
+  const struct bundle_entry *entries;
+};
+
+/* The locale directories looked at so far.  Protected by the lock in
+   _nl_load_domain.  */
+static struct loaded_bundle *loaded_bundles;
+
+/* Load the bundle of the locale directory DIRNAME, of length DIRNAME_LEN,
+   and add it to LOADED_BUNDLES.  Return NULL if memory was exhausted.  */
+static struct loaded_bundle *
+load_bundle (const char *dirname, size_t dirname_len)
+{
+  struct loaded_bundle *bundle;
+  char *filename;
+  int fd;
+#ifdef _LIBC
+  struct stat64 st;
+#else
+  struct stat st;
+#endif
+  size_t size;
+
+  bundle = (struct loaded_bundle *)
+    malloc (sizeof (struct loaded_bundle) + dirname_len + 1);
+  if (bundle == NULL)
+    return NULL;
+  memcpy ((char *) (bundle + 1), dirname, dirname_len);
+  ((char *) (bundle + 1))[dirname_len] = '\0';
+  bundle->dirname = (char *) (bundle + 1);
+  bundle->dirname_len = dirname_len;
+  bundle->data = NULL;
+
+  filename = (char *) malloc (dirname_len + sizeof ("/" BUNDLE_FILENAME));
+  if (filename == NULL)
+    {
+      free (bundle);
+      return NULL;
+    }
+  memcpy (filename, dirname, dirname_len);
+  memcpy (filename + dirname_len, "/" BUNDLE_FILENAME,
+	  sizeof ("/" BUNDLE_FILENAME));
+  fd = (dir_may_contain (dirname, dirname_len,
+			BUNDLE_FILENAME, strlen (BUNDLE_FILENAME))
+	? open (filename, O_RDONLY | O_BINARY)
+	: -1);
+  free (filename);
+
+  if (fd != -1)
+    {
+      if (
+#ifdef _LIBC
+	  fstat64 (fd, &st) == 0
+#else
+	  fstat (fd, &st) == 0
+#endif
+	  && (size = (size_t) st.st_size) == st.st_size
+	  && size >= sizeof (struct bundle_header))
+	{
+	  int use_mmap;
+	  const struct bundle_header *header =
+	    (const struct bundle_header *) load_file (fd, size, &use_mmap);
+
+	  if (header != NULL)
+	    {
+	      int must_swap = header->magic != _MAGIC_BUNDLE;
+	      nls_uint32 nentries = W (must_swap, header->nentries);
+	      nls_uint32 entries_offset = W (must_swap, header->entries_offset);
+
+	      if ((header->magic == _MAGIC_BUNDLE
+		   || header->magic == _MAGIC_BUNDLE_SWAPPED)
+		  && W (must_swap, header->revision) == BUNDLE_REVISION_NUMBER
+		  && entries_offset % 4 == 0
+		  && entries_offset <= size
+		  && nentries <= ((size - entries_offset)
+				  / sizeof (struct bundle_entry)))
+		{
+		  bundle->data = (const char *) header;
+		  bundle->size = size;
+		  bundle->use_mmap = use_mmap;
+		  bundle->must_swap = must_swap;
+		  bundle->nentries = nentries;
+		  bundle->entries = (const struct bundle_entry *)
+		    ((const char *) header + entries_offset);
+		}
+	      else
+		/* This is not a valid bundle.  */
+		unload_file ((const char *) header, size, use_mmap);
+	    }
+	}
+      close (fd);
+    }
+
+  bundle->next = loaded_bundles;
+  loaded_bundles = bundle;
+  return bundle;
+}
+
+/* Return 1 if BUNDLE contains a .mo file whose name, relative to the
+   locale directory, ends in "/SUFFIX", 0 otherwise.  */
+static int
+bundle_lists (const struct loaded_bundle *bundle, const char *suffix)
+{
+  size_t suffix_len = strlen (suffix);
+  nls_uint32 act;
+
+  for (act = 0; act < bundle->nentries; act++)
+    {
+      const struct bundle_entry *entry = &bundle->entries[act];
+      nls_uint32 name_offset = W (bundle->must_swap, entry->name_offset);
+      nls_uint32 name_length = W (bundle->must_swap, entry->name_length);
+
+      if (name_offset < bundle->size
+	  && name_length < bundle->size - name_offset
+	  && name_length > suffix_len
+	  && bundle->data[name_offset + name_length - suffix_len - 1] == '/'
+	  && memcmp (bundle->data + name_offset + name_length - suffix_len,
+		     suffix, suffix_len) == 0)
+	return 1;
+    }
+  return 0;
+}
+
+/* Look up the .mo file FILENAME in the bundle of its locale directory.
+   Set *IN_BUNDLEP to 1 if that directory has a bundle that lists the
+   domain of FILENAME, to 0 otherwise.  Return the contents of the .mo
+   file, and store its size in *SIZEP and in *USE_MMAPP whether it is
+   mmap()ed, or return NULL if there is no such file in a bundle.  */
+static const char *
+find_in_bundle (const char *filename, size_t *sizep, int *use_mmapp,
+		int *in_bundlep)
+{
+  const char *name;
+  int slashes;
+  struct loaded_bundle *bundle;
+  nls_uint32 bottom;
+  nls_uint32 top;
+
+  *in_bundlep = 0;
+
+  /* FILENAME is DIRNAME/LOCALE/CATEGORY/DOMAIN.mo.  Find DIRNAME.  */
+  name = filename + strlen (filename);
+  for (slashes = 0; slashes < 3; )
+    {
+      if (name == filename)
+	return NULL;
+      if (*--name == '/')
+	slashes++;
+    }
+
+  for (bundle = loaded_bundles; bundle != NULL; bundle = bundle->next)
+    if (bundle->dirname_len == (size_t) (name - filename)
+	&& memcmp (bundle->dirname, filename, bundle->dirname_len) == 0)
+      break;
+  if (bundle == NULL)
+    {
+      bundle = load_bundle (filename, name - filename);
+      if (bundle == NULL)
+	return NULL;
+    }
+  if (bundle->data == NULL)
+    return NULL;
+  name++;
+
+  /* Do a binary search in the sorted table of names.  */
+  bottom = 0;
+  top = bundle->nentries;
+  while (bottom < top)
+    {
+      nls_uint32 act = (bottom + top) / 2;
+      const struct bundle_entry *entry = &bundle->entries[act];
+      nls_uint32 name_offset = W (bundle->must_swap, entry->name_offset);
+      nls_uint32 name_length = W (bundle->must_swap, entry->name_length);
+      int cmp;
+
+      if (__builtin_expect (name_offset >= bundle->size
+			    || name_length >= bundle->size - name_offset
+			    || bundle->data[name_offset + name_length] != '\0',
+			    0))
+	/* This is an invalid bundle.  */
+	return NULL;
+
+      cmp = strcmp (name, bundle->data + name_offset);
+      if (cmp < 0)
+	top = act;
+      else if (cmp > 0)
+	bottom = act + 1;
+      else
+	{
+	  nls_uint32 data_offset = W (bundle->must_swap, entry->data_offset);
+	  nls_uint32 data_length = W (bundle->must_swap, entry->data_length);
+
+	  if (__builtin_expect (data_offset % 8 != 0
+				|| data_offset > bundle->size
+				|| data_length > bundle->size - data_offset,
+				0))
+	    /* This is an invalid bundle.  */
+	    return NULL;
+
+	  *in_bundlep = 1;
+	  *sizep = data_length;
+	  *use_mmapp = bundle->use_mmap;
+	  return bundle->data + data_offset;
+	}
+    }
+
+  /* The bundle takes the place of the files below the locale directory
+     only for the domains it lists: a locale directory may be shared by
+     several packages, and only some of them may have installed their
+     catalogs in the bundle.  For the other domains, the .mo files beside
+     the bundle are used.  */
+  *in_bundlep = bundle_lists (bundle, strchr (name, '/') + 1);
+  return NULL;
+}
+
+/* A plural rule, parsed and compiled once, and shared by the message
+   catalogs whose header entries specify it with the same text.  */
+struct plural_rule
+{
+  struct plural_rule *next;
+  const struct expression *plural;
+  unsigned long int nplurals;
+  const struct plural_program *plural_program;
+  /* The text of the header lines that contain "nplurals=" and "plural=",
+     usually just the "Plural-Forms:" line.  */
+  size_t key_length;
+  char key[ZERO];
+};
+
+/* The plural rules seen so far.  Protected by the lock of
+   _nl_load_domain.  */
+static struct plural_rule *plural_rules;
+
+/* Return the start of the line of NULLENTRY that contains P.  */
+static const char *
+line_start (const char *nullentry, const char *p)
+{
+  while (p > nullentry && p[-1] != '\n')
+    p--;
+  return p;
+}
+
+/* Return the end of the line that contains P.  */
+static const char *
+line_end (const char *p)
+{
+  const char *end = strchr (p, '\n');
+
+  return (end != NULL ? end : p + strlen (p));
+}
+
+/* Set the plural rule of DOMAIN from the header entry NULLENTRY.  The
+   rule is looked up among those of the message catalogs loaded before,
+   and parsed only if none of them specified it.
+   The caller must hold the lock of _nl_load_domain.  */
+static void
+set_plural_rule (struct loaded_domain *domain, const char *nullentry)
+{
+  const char *key = NULL;
+  size_t key_length = 0;
+  struct plural_rule *rule;
+
+  if (nullentry != NULL)
+    {
+      const char *plural = strstr (nullentry, "plural=");
+      const char *nplurals = strstr (nullentry, "nplurals=");
+
+      if (plural != NULL && nplurals != NULL)
+	{
+	  const char *start = line_start (nullentry,
+					  plural < nplurals ? plural : nplurals);
+	  const char *end = line_end (plural < nplurals ? nplurals : plural);
+
+	  key = start;
+	  key_length = end - start;
+	}
+    }
+
+  if (key != NULL)
+    for (rule = plural_rules; rule != NULL; rule = rule->next)
+      if (rule->key_length == key_length
+	  && memcmp (rule->key, key, key_length) == 0)
+	{
+	  domain->plural = rule->plural;
+	  domain->nplurals = rule->nplurals;
+	  domain->plural_program = rule->plural_program;
+	  domain->plural_shared = 1;
+	  return;
+	}
+
+  EXTRACT_PLURAL_EXPRESSION (nullentry, &domain->plural, &domain->nplurals);
+  domain->plural_program =
+    COMPILE_PLURAL_EXPRESSION (nullentry, domain->plural);
+  domain->plural_shared = 0;
+
+  if (key != NULL)
+    {
+      /* Remember the rule for the next catalogs.  If memory is exhausted,
+	 DOMAIN keeps a rule of its own.  */
+      rule = (struct plural_rule *)
+	malloc (offsetof (struct plural_rule, key) + key_length);
+      if (rule != NULL)
+	{
+	  rule->plural = domain->plural;
+	  rule->nplurals = domain->nplurals;
+	  rule->plural_program = domain->plural_program;
+	  rule->key_length = key_length;
+	  memcpy (rule->key, key, key_length);
+	  rule->next = plural_rules;
+	  plural_rules = rule;
+	  domain->plural_shared = 1;
+	}
+    }
+}
+
 /* Load the message catalogs specified by FILENAME.  If it is no valid
    message catalog do nothing.  */
 void
@@ -788,8 +1521,9 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 #else
   struct stat st;
 #endif
-  struct mo_file_header *data = (struct mo_file_header *) -1;
+  struct mo_file_header *data;
   int use_mmap = 0;
+  int in_bundle;
   struct loaded_domain *domain;
   int revision;
   const char *nullentry;
@@ -824,66 +1558,47 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
   if (domain_file->filename == NULL)
     goto out;
 
-  /* Try to open the addressed file.  */
-  fd = open (domain_file->filename, O_RDONLY | O_BINARY);
-  if (fd == -1)
-    goto out;
-
-  /* We must know about the size of the file.  */
-  if (
-#ifdef _LIBC
-      __builtin_expect (fstat64 (fd, &st) != 0, 0)
-#else
-      __builtin_expect (fstat (fd, &st) != 0, 0)
-#endif
-      || __builtin_expect ((size = (size_t) st.st_size) != st.st_size, 0)
-      || __builtin_expect (size < sizeof (struct mo_file_header), 0))
-    /* Something went wrong.  */
-    goto out;
-
-#ifdef HAVE_MMAP
-  /* Now we are ready to load the file.  If mmap() is available we try
-     this first.  If not available or it failed we try to load it.  */
-  data = (struct mo_file_header *) mmap (NULL, size, PROT_READ,
-					 MAP_PRIVATE, fd, 0);
-
-  if (__builtin_expect (data != (struct mo_file_header *) -1, 1))
+  /* A catalog whose domain is in the bundle of its locale directory is
+     taken from the bundle, without looking at the file system.  */
+  data = (struct mo_file_header *)
+    find_in_bundle (domain_file->filename, &size, &use_mmap, &in_bundle);
+  if (in_bundle)
     {
-      /* mmap() call was successful.  */
-      close (fd);
-      fd = -1;
-      use_mmap = 1;
+      if (data == NULL
+	  /* Files with minor revision < 2 lack the last header fields.  */
+	  || size < offsetof (struct mo_file_header, hash2_function))
+	goto out;
     }
-#endif
-
-  /* If the data is not yet available (i.e. mmap'ed) we try to load
-     it manually.  */
-  if (data == (struct mo_file_header *) -1)
+  else
     {
-      size_t to_read;
-      char *read_ptr;
+      /* Don't try to open a file that the listings of its directories
+	 show to be missing.  */
+      if (!catalog_may_exist (domain_file->filename))
+	goto out;
 
-      data = (struct mo_file_header *) malloc (size);
-      if (data == NULL)
+      /* Try to open the addressed file.  */
+      fd = open (domain_file->filename, O_RDONLY | O_BINARY);
+      if (fd == -1)
 	goto out;
 
-      to_read = size;
-      read_ptr = (char *) data;
-      do
-	{
-	  long int nb = (long int) read (fd, read_ptr, to_read);
-	  if (nb <= 0)
-	    {
-#ifdef EINTR
-	      if (nb == -1 && errno == EINTR)
-		continue;
+      /* We must know about the size of the file.  */
+      if (
+#ifdef _LIBC
+	  __builtin_expect (fstat64 (fd, &st) != 0, 0)
+#else
+	  __builtin_expect (fstat (fd, &st) != 0, 0)
 #endif
-	      goto out;
-	    }
-	  read_ptr += nb;
-	  to_read -= nb;
-	}
-      while (to_read > 0);
+	  || __builtin_expect ((size = (size_t) st.st_size) != st.st_size, 0)
+	  /* Files with minor revision < 2 lack the last header fields.  */
+	  || __builtin_expect (size < offsetof (struct mo_file_header,
+						hash2_function), 0))
+	/* Something went wrong.  */
+	goto out;
+
+      /* Now we are ready to load the file.  */
+      data = (struct mo_file_header *) load_file (fd, size, &use_mmap);
+      if (data == NULL)
+	goto out;
 
       close (fd);
       fd = -1;
@@ -895,12 +1610,8 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 			0))
     {
       /* The magic number is wrong: not a message catalog file.  */
-#ifdef HAVE_MMAP
-      if (use_mmap)
-	munmap ((caddr_t) data, size);
-      else
-#endif
-	free (data);
+      if (!in_bundle)
+	unload_file ((const char *) data, size, use_mmap);
       goto out;
     }
 
@@ -911,9 +1622,25 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 
   domain->data = (char *) data;
   domain->use_mmap = use_mmap;
+  domain->in_bundle = in_bundle;
   domain->mmap_size = size;
   domain->must_swap = data->magic != _MAGIC;
   domain->malloced = NULL;
+#ifndef _LIBC
+  if (in_bundle)
+    {
+      domain->dev = 0;
+      domain->ino = 0;
+      domain->mtime = 0;
+    }
+  else
+    {
+      domain->dev = st.st_dev;
+      domain->ino = st.st_ino;
+      domain->mtime = st.st_mtime;
+    }
+  domain->previous = NULL;
+#endif
 
   /* Fill in the information about the available tables.  */
   revision = W (domain->must_swap, data->revision);
@@ -934,6 +1661,8 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 	   ((char *) data + W (domain->must_swap, data->hash_tab_offset))
 	 : NULL);
       domain->must_swap_hash_tab = domain->must_swap;
+      domain->hash2_size = 0;
+      domain->hash2_tab = NULL;
 
       /* Now dispatch on the minor revision.  */
       switch (revision & 0xffff)
@@ -952,6 +1681,34 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 	      /* This is invalid.  These minor revisions need a hash table.  */
 	      goto invalid;
 
+	    /* Minor revisions >= 2 may add a secondary hash table, built with
+	       a faster hash function.  Ignore it if we don't know its hash
+	       function or if it doesn't fit in the file.  */
+	    if ((revision & 0xffff) >= 2
+		&& size >= sizeof (struct mo_file_header))
+	      {
+		nls_uint32 hash2_function =
+		  W (domain->must_swap, data->hash2_function);
+
+		if (hash2_function == MO_HASH_FUNCTION_MURMUR3_WITH_FINGERPRINTS)
+		  {
+		    size_t entry_size = 2 * sizeof (nls_uint32);
+		    nls_uint32 hash2_size =
+		      W (domain->must_swap, data->hash2_tab_size);
+		    nls_uint32 hash2_offset =
+		      W (domain->must_swap, data->hash2_tab_offset);
+
+		    if (hash2_size > 0 && (hash2_size & (hash2_size - 1)) == 0
+			&& hash2_offset <= size
+			&& hash2_size <= (size - hash2_offset) / entry_size)
+		      {
+			domain->hash2_size = hash2_size;
+			domain->hash2_tab =
+			  (const nls_uint32 *) ((char *) data + hash2_offset);
+		      }
+		  }
+	      }
+
 	    n_sysdep_strings =
 	      W (domain->must_swap, data->n_sysdep_strings);
 	    if (n_sysdep_strings > 0)
@@ -967,6 +1724,8 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 		struct sysdep_string_desc *inmem_orig_sysdep_tab;
 		struct sysdep_string_desc *inmem_trans_sysdep_tab;
 		nls_uint32 *inmem_hash_tab;
+		nls_uint32 *inmem_hash2_tab;
+		size_t hash2_words;
 		unsigned int i, j;
 
 		/* Get the values of the system dependent segments.  */
@@ -1007,7 +1766,9 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 		   At the same time, also drop string pairs which refer to
 		   an undefined system dependent segment.  */
 		n_inmem_sysdep_strings = 0;
-		memneed = domain->hash_size * sizeof (nls_uint32);
+		hash2_words = 2 * domain->hash2_size;
+		memneed =
+		  (domain->hash_size + hash2_words) * sizeof (nls_uint32);
 		for (i = 0; i < n_sysdep_strings; i++)
 		  {
 		    int valid = 1;
@@ -1085,6 +1846,8 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 			   * sizeof (struct sysdep_string_desc);
 		    inmem_hash_tab = (nls_uint32 *) mem;
 		    mem += domain->hash_size * sizeof (nls_uint32);
+		    inmem_hash2_tab = (nls_uint32 *) mem;
+		    mem += hash2_words * sizeof (nls_uint32);
 
 		    /* Compute the system dependent strings.  */
 		    k = 0;
@@ -1228,6 +1991,29 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 			      idx += incr;
 			  }
 		      }
+		    if (domain->hash2_tab != NULL)
+		      {
+			nls_uint32 mask = domain->hash2_size - 1;
+			for (i = 0; i < hash2_words; i++)
+			  inmem_hash2_tab[i] =
+			    W (domain->must_swap_hash_tab,
+			       domain->hash2_tab[i]);
+			for (i = 0; i < n_inmem_sysdep_strings; i++)
+			  {
+			    const char *msgid =
+			      inmem_orig_sysdep_tab[i].pointer;
+			    nls_uint32 hash_val =
+			      __hash_string_murmur3 (msgid, strlen (msgid));
+			    nls_uint32 idx = hash_val & mask;
+
+			    /* Linear probing.  */
+			    while (inmem_hash2_tab[2 * idx] != 0)
+			      idx = (idx + 1) & mask;
+			    inmem_hash2_tab[2 * idx] = 1 + domain->nstrings + i;
+			    inmem_hash2_tab[2 * idx + 1] = hash_val;
+			  }
+			domain->hash2_tab = inmem_hash2_tab;
+		      }
 
 		    domain->n_sysdep_strings = n_inmem_sysdep_strings;
 		    domain->orig_sysdep_tab = inmem_orig_sysdep_tab;
@@ -1260,12 +2046,8 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
     invalid:
       /* This is an invalid .mo file.  */
       free (domain->malloced);
-#ifdef HAVE_MMAP
-      if (use_mmap)
-	munmap ((caddr_t) data, size);
-      else
-#endif
-	free (data);
+      if (!in_bundle)
+	unload_file ((const char *) data, size, use_mmap);
       free (domain);
       domain_file->data = NULL;
       goto out;
@@ -1279,16 +2061,27 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
   /* Get the header entry and look for a plural specification.  */
 #ifdef IN_LIBGLOCALE
   nullentry =
-    _nl_find_msg (domain_file, domainbinding, NULL, "", &nullentrylen);
+    _nl_find_msg (domain_file, domainbinding, NULL, "", &nullentrylen, NULL);
 #else
-  nullentry = _nl_find_msg (domain_file, domainbinding, "", 0, &nullentrylen);
+  nullentry =
+    _nl_find_msg (domain_file, domainbinding, "", 0, &nullentrylen, NULL);
 #endif
-  EXTRACT_PLURAL_EXPRESSION (nullentry, &domain->plural, &domain->nplurals);
+  set_plural_rule (domain, nullentry);
+  memset (domain->plural_indices, PLURAL_INDEX_UNKNOWN,
+	  sizeof (domain->plural_indices));
 
  out:
   if (fd != -1)
     close (fd);
 
+  if (domain_file->filename != NULL)
+    {
+      if (domain_file->data != NULL)
+	DOMAIN_STATS_COUNT_FILE (domain_file->filename, catalogs_loaded);
+      else
+	DOMAIN_STATS_COUNT_FILE (domain_file->filename, catalogs_missing);
+    }
+
   domain_file->decided = 1;
 
  done:
@@ -1296,6 +2089,148 @@ _nl_load_domain (struct loaded_l10nfile *domain_file,
 }
 
 
+#if defined HAVE_MMAP && (defined _LIBC || defined _SC_PAGESIZE) \
+    && (defined _LIBC || defined HAVE_MADVISE || defined HAVE_MINCORE)
+/* Store in *STARTP and *LENGTHP the smallest range of whole pages that
+   contains the memory of DOMAIN, which is not page aligned if DOMAIN is
+   part of a bundle.  Return the size of a page, or 0 if unknown.  */
+static size_t
+page_range (const struct loaded_domain *domain, char **startp,
+	    size_t *lengthp)
+{
+# ifdef _LIBC
+  long int pagesize = __getpagesize ();
+# else
+  long int pagesize = sysconf (_SC_PAGESIZE);
+# endif
+  size_t offset;
+
+  if (pagesize <= 0)
+    return 0;
+  offset = (unsigned long int) domain->data % (unsigned long int) pagesize;
+  *startp = (char *) domain->data - offset;
+  *lengthp = domain->mmap_size + offset;
+  return pagesize;
+}
+#endif
+
+#ifndef _LIBC
+/* Store the memory usage of the message catalog DOMAIN_FILE, which must
+   have been loaded, in *STATSP.  */
+void
+internal_function
+_nl_get_catalog_stats (const struct loaded_l10nfile *domain_file,
+		       struct libintl_catalog_stats *statsp)
+{
+  const struct loaded_domain *domain =
+    (const struct loaded_domain *) domain_file->data;
+
+  statsp->filename = domain_file->filename;
+  statsp->resident_pages = (size_t)(-1);
+  if (domain->use_mmap)
+    {
+      statsp->mapped_bytes = domain->mmap_size;
+      statsp->read_bytes = 0;
+# if defined HAVE_MMAP && defined HAVE_MINCORE && defined _SC_PAGESIZE
+      {
+	char *start;
+	size_t length;
+	size_t pagesize = page_range (domain, &start, &length);
+
+	if (pagesize > 0)
+	  {
+	    size_t npages = (length + pagesize - 1) / pagesize;
+	    unsigned char *vec = (unsigned char *) malloc (npages);
+
+	    if (vec != NULL)
+	      {
+		/* The type of the last argument is 'unsigned char *' on some
+		   systems and 'char *' on others.  */
+		if (mincore ((caddr_t) start, length, (void *) vec) == 0)
+		  {
+		    size_t i;
+
+		    statsp->resident_pages = 0;
+		    for (i = 0; i < npages; i++)
+		      if (vec[i] & 1)
+			statsp->resident_pages++;
+		  }
+		free (vec);
+	      }
+	  }
+      }
+# endif
+    }
+  else
+    {
+      statsp->mapped_bytes = 0;
+      statsp->read_bytes = domain->mmap_size;
+    }
+}
+#endif
+
+/* Tell the kernel that the pages of the message catalog DOMAIN_FILE will
+   soon be accessed, so that they are read in before the first lookup.  */
+void
+internal_function
+_nl_advise_domain (struct loaded_l10nfile *domain_file)
+{
+#if defined HAVE_MMAP && (defined _LIBC || defined HAVE_MADVISE) \
+    && defined MADV_WILLNEED && (defined _LIBC || defined _SC_PAGESIZE)
+  struct loaded_domain *domain =
+    (struct loaded_domain *) domain_file->data;
+  char *start;
+  size_t length;
+
+  if (domain != NULL && domain->use_mmap
+      && page_range (domain, &start, &length) > 0)
+    madvise ((caddr_t) start, length, MADV_WILLNEED);
+#endif
+}
+
+#ifndef _LIBC
+/* Read the message catalog DOMAIN_FILE, which must have been loaded, again
+   if its file has changed since, and make the lookups use the new contents.
+   Lookups that are running meanwhile see either the old or the new
+   contents.  The old contents are not freed, because the translations that
+   were looked up in them may still be in use.  Return 1 if the catalog was
+   reloaded, 0 if it is unchanged, or if the new file is missing or not a
+   valid message catalog.  */
+int
+internal_function
+_nl_reload_domain (struct loaded_l10nfile *domain_file,
+		   struct binding *domainbinding)
+{
+  const struct loaded_domain *domain =
+    (const struct loaded_domain *) domain_file->data;
+  struct loaded_l10nfile new_file;
+  struct stat st;
+
+  /* A bundle is not read again, so neither are the catalogs in it.  */
+  if (domain == NULL || domain->in_bundle)
+    return 0;
+
+  if (stat (domain_file->filename, &st) != 0
+      || (st.st_dev == domain->dev && st.st_ino == domain->ino
+	  && st.st_mtime == domain->mtime
+	  && (size_t) st.st_size == domain->mmap_size))
+    return 0;
+
+  /* Load the file into a record of its own, so that the lookups continue
+     to use the old contents until the new ones are complete.  */
+  memset (&new_file, '\0', sizeof (new_file));
+  new_file.filename = domain_file->filename;
+  _nl_load_domain (&new_file, domainbinding);
+  if (new_file.data == NULL)
+    return 0;
+
+  ((struct loaded_domain *) new_file.data)->previous = domain;
+  ATOMIC_STORE_RELEASE (domain_file->data, new_file.data);
+  return 1;
+}
+#endif
+
+
 #ifdef _LIBC
 void
 internal_function __libc_freeres_fn_section
@@ -1303,31 +2238,49 @@ _nl_unload_domain (struct loaded_domain *domain)
 {
   size_t i;
 
-  if (domain->plural != &__gettext_germanic_plural)
-    __gettext_free_exp ((struct expression *) domain->plural);
+  if (!domain->plural_shared)
+    {
+      __gettext_free_plural_program (domain->plural_program);
+      if (domain->plural != &__gettext_germanic_plural)
+	__gettext_free_exp ((struct expression *) domain->plural);
+    }
 
   for (i = 0; i < domain->nconversions; i++)
     {
-      struct converted_domain *convd = &domain->conversions[i];
+      struct converted_domain *convd = domain->conversions[i];
 
       free (convd->encoding);
       if (convd->conv_tab != NULL && convd->conv_tab != (char **) -1)
 	free (convd->conv_tab);
+      free (convd->conv_mem);
       if (convd->conv != (__gconv_t) -1)
 	__gconv_close (convd->conv);
+      __libc_lock_fini (convd->lock);
+      free (convd);
     }
   free (domain->conversions);
   __libc_rwlock_fini (domain->conversions_lock);
 
   free (domain->malloced);
 
-# ifdef _POSIX_MAPPED_FILES
-  if (domain->use_mmap)
-    munmap ((caddr_t) domain->data, domain->mmap_size);
-  else
-# endif	/* _POSIX_MAPPED_FILES */
-    free ((void *) domain->data);
+  if (!domain->in_bundle)
+    unload_file (domain->data, domain->mmap_size, domain->use_mmap);
 
   free (domain);
 }
+
+/* Free the plural rules shared by the message catalogs.  */
+libc_freeres_fn (free_plural_rules)
+{
+  while (plural_rules != NULL)
+    {
+      struct plural_rule *rule = plural_rules;
+
+      plural_rules = rule->next;
+      __gettext_free_plural_program (rule->plural_program);
+      if (rule->plural != &__gettext_germanic_plural)
+	__gettext_free_exp ((struct expression *) rule->plural);
+      free (rule);
+    }
+}
 #endif
@@ -58,6 +58,22 @@ char *alloca ();
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef _LIBC
+# include <fcntl.h>
+# include <sys/stat.h>
+# ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+# endif
+# if defined HAVE_MMAP && defined HAVE_MUNMAP && !defined DISALLOW_MMAP
+#  include <sys/mman.h>
+#  undef HAVE_MMAP
+#  define HAVE_MMAP 1
+# else
+#  undef HAVE_MMAP
+# endif
+#endif
+
+#include "gmo.h"
 #include "gettextP.h"
 
 #if ENABLE_RELOCATABLE
@@ -110,6 +126,21 @@ char *alloca ();
 # define freea(p) free (p)
 #endif
 
+/* For systems that distinguish between text and binary I/O.
+   O_BINARY is usually declared in <fcntl.h>. */
+#if !defined O_BINARY && defined _O_BINARY
+  /* For MSC-compatible compilers.  */
+# define O_BINARY _O_BINARY
+#endif
+#ifdef __BEOS__
+  /* BeOS 5 has O_BINARY and O_TEXT, but they have no effect.  */
+# undef O_BINARY
+#endif
+/* On reasonable systems, binary I/O is the default.  */
+#ifndef O_BINARY
+# define O_BINARY 0
+#endif
+
 #if defined _LIBC_REENTRANT || HAVE_DECL_FGETS_UNLOCKED
 # undef fgets
 # define fgets(buf, len, s) fgets_unlocked (buf, len, s)
@@ -141,10 +172,36 @@ libc_freeres_ptr (static struct alias_map *map);
 static size_t nmap;
 static size_t maxmap;
 
+#ifndef _LIBC
+/* An alias index that was loaded instead of a locale.alias file.  */
+struct alias_index
+{
+  struct alias_index *next;
+  /* The contents of the file.  */
+  const char *data;
+  size_t size;
+  /* 1 if the file is mmap()ed, 0 if it is read into malloc()ed memory.  */
+  int use_mmap;
+  /* 1 if the file uses a different endianness than this machine.  */
+  int must_swap;
+  /* The table of aliases, sorted.  */
+  nls_uint32 nentries;
+  const struct alias_index_entry *entries;
+};
+
+/* The alias indexes loaded so far, in the order of the alias path.  */
+static struct alias_index *alias_indexes;
+#endif
+
 
 /* Prototypes for local functions.  */
 static size_t read_alias_file (const char *fname, int fname_len)
      internal_function;
+#ifndef _LIBC
+static size_t read_alias_index (const char *index_fname,
+				const char *fname);
+static const char *find_in_alias_indexes (const char *name);
+#endif
 static int extend_alias_table (void);
 static int alias_compare (const struct alias_map *map1,
 			  const struct alias_map *map2);
@@ -185,6 +242,13 @@ _nl_expand_alias (const char *name)
 	  break;
 	}
 
+#ifndef _LIBC
+      /* Look in the alias indexes.  */
+      result = find_in_alias_indexes (name);
+      if (result != NULL)
+	break;
+#endif
+
       /* Perhaps we can find another alias file.  */
       added = 0;
       while (added == 0 && locale_alias_path[0] != '\0')
@@ -219,6 +283,10 @@ read_alias_file (const char *fname, int fname_len)
   char *full_fname;
   size_t added;
   static const char aliasfile[] = "/locale.alias";
+#ifndef _LIBC
+  static const char indexfile[] = "/" ALIAS_INDEX_FILENAME;
+  char *index_fname;
+#endif
 
   full_fname = (char *) alloca (fname_len + sizeof aliasfile);
 #ifdef HAVE_MEMPCPY
@@ -229,6 +297,20 @@ read_alias_file (const char *fname, int fname_len)
   memcpy (&full_fname[fname_len], aliasfile, sizeof aliasfile);
 #endif
 
+#ifndef _LIBC
+  /* Prefer the alias index, if it is up to date.  */
+  index_fname = (char *) alloca (fname_len + sizeof indexfile);
+  memcpy (index_fname, fname, fname_len);
+  memcpy (&index_fname[fname_len], indexfile, sizeof indexfile);
+  added = read_alias_index (relocate (index_fname), relocate (full_fname));
+  freea (index_fname);
+  if (added > 0)
+    {
+      freea (full_fname);
+      return added;
+    }
+#endif
+
 #ifdef _LIBC
   /* Note the file is opened with cancellation in the I/O functions
      disabled.  */
@@ -435,3 +517,188 @@ alias_compare (const struct alias_map *map1, const struct alias_map *map2)
   return c1 - c2;
 #endif
 }
+
+
+#ifndef _LIBC
+/* Compare S1 and S2 like strcasecmp in the "C" locale.  This is the order
+   of the aliases in an alias index.  */
+static int
+ascii_casecmp (const char *s1, const char *s2)
+{
+  for (;; s1++, s2++)
+    {
+      unsigned char c1 = *s1;
+      unsigned char c2 = *s2;
+
+      if (c1 >= 'A' && c1 <= 'Z')
+	c1 += 'a' - 'A';
+      if (c2 >= 'A' && c2 <= 'Z')
+	c2 += 'a' - 'A';
+      if (c1 != c2 || c1 == '\0')
+	return (int) c1 - (int) c2;
+    }
+}
+
+/* Load the alias index INDEX_FNAME, unless it is older than the alias
+   file FNAME it was compiled from.  Return the number of aliases it
+   contains, or 0 if it cannot be used.  */
+static size_t
+read_alias_index (const char *index_fname, const char *fname)
+{
+  int fd;
+  struct stat st;
+  struct stat text_st;
+  size_t size;
+  char *data;
+  int use_mmap = 0;
+  const struct alias_index_header *header;
+  struct alias_index *index;
+  struct alias_index **lastp;
+  int must_swap;
+  nls_uint32 nentries;
+  nls_uint32 entries_offset;
+
+  fd = open (index_fname, O_RDONLY | O_BINARY);
+  if (fd == -1)
+    return 0;
+
+  if (fstat (fd, &st) != 0
+      || (size = (size_t) st.st_size) != st.st_size
+      || size < sizeof (struct alias_index_header)
+      /* An index older than its locale.alias file is out of date.  */
+      || (stat (fname, &text_st) == 0 && text_st.st_mtime > st.st_mtime))
+    {
+      close (fd);
+      return 0;
+    }
+
+  data = NULL;
+# ifdef HAVE_MMAP
+  data = (char *) mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data != MAP_FAILED)
+    use_mmap = 1;
+  else
+    data = NULL;
+# endif
+  if (data == NULL)
+    {
+      size_t to_read;
+      char *readp;
+
+      data = (char *) malloc (size);
+      if (data == NULL)
+	{
+	  close (fd);
+	  return 0;
+	}
+      to_read = size;
+      readp = data;
+      do
+	{
+	  long int nb = (long int) read (fd, readp, to_read);
+	  if (nb <= 0)
+	    {
+	      free (data);
+	      close (fd);
+	      return 0;
+	    }
+	  readp += nb;
+	  to_read -= nb;
+	}
+      while (to_read > 0);
+    }
+  close (fd);
+
+  /* Check the header.  The strings are NUL terminated if the file ends in
+     a NUL.  */
+  header = (const struct alias_index_header *) data;
+  must_swap = header->magic != _MAGIC_ALIAS;
+  nentries = W (must_swap, header->nentries);
+  entries_offset = W (must_swap, header->entries_offset);
+  index = NULL;
+  if ((header->magic == _MAGIC_ALIAS || header->magic == _MAGIC_ALIAS_SWAPPED)
+      && W (must_swap, header->revision) == ALIAS_REVISION_NUMBER
+      && entries_offset % 4 == 0
+      && entries_offset <= size
+      && nentries <= ((size - entries_offset)
+		      / sizeof (struct alias_index_entry))
+      && nentries > 0
+      && data[size - 1] == '\0')
+    index = (struct alias_index *) malloc (sizeof (struct alias_index));
+  if (index == NULL)
+    {
+# ifdef HAVE_MMAP
+      if (use_mmap)
+	munmap ((caddr_t) data, size);
+      else
+# endif
+	free (data);
+      return 0;
+    }
+
+  index->data = data;
+  index->size = size;
+  index->use_mmap = use_mmap;
+  index->must_swap = must_swap;
+  index->nentries = nentries;
+  index->entries =
+    (const struct alias_index_entry *) (data + entries_offset);
+
+  /* Keep the indexes in the order of the alias path.  */
+  index->next = NULL;
+  for (lastp = &alias_indexes; *lastp != NULL; lastp = &(*lastp)->next)
+    ;
+  *lastp = index;
+
+  return nentries;
+}
+
+/* Look up the alias NAME in the alias indexes loaded so far.  Return the
+   locale name it stands for, or NULL.  */
+static const char *
+find_in_alias_indexes (const char *name)
+{
+  struct alias_index *index;
+
+# ifdef IN_LIBGLOCALE
+  /* Like read_alias_file, ignore the aliases that contain a '_'.  */
+  if (strchr (name, '_') != NULL)
+    return NULL;
+# endif
+
+  for (index = alias_indexes; index != NULL; index = index->next)
+    {
+      nls_uint32 bottom = 0;
+      nls_uint32 top = index->nentries;
+
+      while (bottom < top)
+	{
+	  nls_uint32 act = (bottom + top) / 2;
+	  const struct alias_index_entry *entry = &index->entries[act];
+	  nls_uint32 alias_offset = W (index->must_swap, entry->alias_offset);
+	  int cmp;
+
+	  if (__builtin_expect (alias_offset >= index->size, 0))
+	    /* This is an invalid alias index.  */
+	    break;
+
+	  cmp = ascii_casecmp (name, index->data + alias_offset);
+	  if (cmp < 0)
+	    top = act;
+	  else if (cmp > 0)
+	    bottom = act + 1;
+	  else
+	    {
+	      nls_uint32 value_offset =
+		W (index->must_swap, entry->value_offset);
+
+	      if (__builtin_expect (value_offset >= index->size, 0))
+		break;
+	      return index->data + value_offset;
+	    }
+	}
+    }
+
+  return NULL;
+}
+#endif
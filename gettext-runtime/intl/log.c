@@ -1,5 +1,5 @@
 /* Log file output.
-   Copyright (C) 2003, 2005, 2009 Free Software Foundation, Inc.
+   Copyright (C) 2003, 2005, 2009, 2026 Free Software Foundation, Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU Lesser General Public License as published by
@@ -20,10 +20,14 @@
 # include <config.h>
 #endif
 
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "gettextP.h"
+#include "hash-string.h"
+
 /* Handle multi-threaded applications.  */
 #ifdef _LIBC
 # include <bits/libc-lock.h>
@@ -34,37 +38,267 @@
 /* Separator between msgctxt and msgid in .mo files.  */
 #define MSGCTXT_SEPARATOR '\004'  /* EOT */
 
-/* Print an ASCII string with quotes and escape sequences where needed.  */
+/* Size of the output that is collected before it is written to the log
+   file.  */
+#define LOG_BUFFER_SIZE 8192
+
+/* A message that has been logged.  */
+struct logged_message
+{
+  unsigned long int hash;
+  const char *logfilename;
+  const char *domainname;
+  const char *msgid1;
+  /* The plural form of MSGID1, or NULL.  */
+  const char *msgid2;
+  char contents[ZERO];
+};
+
+/* Hash table of the logged messages, with open addressing.  Lookups don't
+   take a lock if HAVE_LOCKFREE_READERS.  Therefore a table, once
+   published, is never freed while the program runs.  */
+struct logged_table
+{
+  /* Number of slots, a power of 2.  */
+  size_t size;
+  /* Number of non-empty slots.  */
+  size_t filled;
+  struct logged_message *slots[ZERO];
+};
+
+/* Initial number of slots in the table of logged messages.  */
+#define LOGGED_TABLE_INITIAL_SIZE 256
+
+/* The messages that have been logged.  */
+static struct logged_table *logged_messages;
+
+static char *last_logfilename = NULL;
+static FILE *last_logfile = NULL;
+
+/* Output for last_logfile that has not been written yet.  */
+static char *pending;
+static size_t pending_length;
+static size_t pending_allocated;
+
+/* Nonzero once flush_at_exit has been registered.  */
+static int flush_registered;
+
+__libc_lock_define_initialized (static, lock)
+
+/* Write the pending output to the log file.
+   The caller must hold the lock.  */
+static void
+flush_pending (void)
+{
+  if (pending_length > 0 && last_logfile != NULL)
+    {
+      fwrite (pending, 1, pending_length, last_logfile);
+      fflush (last_logfile);
+    }
+  pending_length = 0;
+}
+
+/* Append the N bytes at STR to the pending output.  */
+static void
+append (const char *str, size_t n)
+{
+  if (pending_length + n > pending_allocated)
+    {
+      size_t new_allocated = 2 * pending_allocated + n + LOG_BUFFER_SIZE;
+      char *new_pending = (char *) realloc (pending, new_allocated);
+
+      if (new_pending != NULL)
+        {
+          pending = new_pending;
+          pending_allocated = new_allocated;
+        }
+      else
+        {
+          /* Out of memory.  Rather than dropping the bytes, write what is
+             buffered, then the bytes directly if they still don't fit.  */
+          flush_pending ();
+          if (n > pending_allocated)
+            {
+              if (last_logfile != NULL)
+                fwrite (str, 1, n, last_logfile);
+              return;
+            }
+        }
+    }
+  memcpy (pending + pending_length, str, n);
+  pending_length += n;
+}
+
+/* Append the string STR to the pending output.  */
+static void
+append_string (const char *str)
+{
+  append (str, strlen (str));
+}
+
+/* Append an ASCII string with quotes and escape sequences where needed to
+   the pending output.  */
 static void
-print_escaped (FILE *stream, const char *str, const char *str_end)
+append_escaped (const char *str, const char *str_end)
 {
-  putc ('"', stream);
+  append ("\"", 1);
   for (; str != str_end; str++)
     if (*str == '\n')
       {
-        fputs ("\\n\"", stream);
+        append ("\\n\"", 3);
         if (str + 1 == str_end)
           return;
-        fputs ("\n\"", stream);
+        append ("\n\"", 2);
       }
     else
       {
         if (*str == '"' || *str == '\\')
-          putc ('\\', stream);
-        putc (*str, stream);
+          append ("\\", 1);
+        append (str, 1);
       }
-  putc ('"', stream);
+  append ("\"", 1);
 }
 
-static char *last_logfilename = NULL;
-static FILE *last_logfile = NULL;
-__libc_lock_define_initialized (static, lock)
+/* Write the pending output when the program exits.  */
+static void
+flush_at_exit (void)
+{
+  __libc_lock_lock (lock);
+  flush_pending ();
+  __libc_lock_unlock (lock);
+}
+
+/* Compute the hash code of a logged message.  */
+static unsigned long int
+logged_hash (const char *domainname, const char *msgid1, const char *msgid2)
+{
+  unsigned long int hash = __hash_string (msgid1);
+
+  hash = hash * 31 + __hash_string (domainname);
+  if (msgid2 != NULL)
+    hash = hash * 31 + __hash_string (msgid2);
+  return hash;
+}
+
+/* Return nonzero if the message in SLOT is the given one.  */
+static inline int
+logged_matches (const struct logged_message *slot, unsigned long int hash,
+                const char *logfilename, const char *domainname,
+                const char *msgid1, const char *msgid2)
+{
+  return (slot->hash == hash
+          && strcmp (slot->msgid1, msgid1) == 0
+          && (slot->msgid2 == NULL
+              ? msgid2 == NULL
+              : msgid2 != NULL && strcmp (slot->msgid2, msgid2) == 0)
+          && strcmp (slot->domainname, domainname) == 0
+          && strcmp (slot->logfilename, logfilename) == 0);
+}
+
+/* Return nonzero if the given message is in TABLE.  */
+static int
+logged_find (const struct logged_table *table, unsigned long int hash,
+             const char *logfilename, const char *domainname,
+             const char *msgid1, const char *msgid2)
+{
+  if (table != NULL)
+    {
+      size_t idx = hash & (table->size - 1);
+
+      for (;;)
+        {
+          const struct logged_message *slot =
+            ATOMIC_LOAD_ACQUIRE (table->slots[idx]);
+
+          if (slot == NULL)
+            break;
+          if (logged_matches (slot, hash, logfilename, domainname,
+                              msgid1, msgid2))
+            return 1;
+          idx = (idx + 1) & (table->size - 1);
+        }
+    }
+  return 0;
+}
+
+/* Store MESSAGE in an empty slot of TABLE.  */
+static void
+logged_store (struct logged_table *table, struct logged_message *message)
+{
+  size_t idx = message->hash & (table->size - 1);
+
+  while (table->slots[idx] != NULL)
+    idx = (idx + 1) & (table->size - 1);
+  ATOMIC_STORE_RELEASE (table->slots[idx], message);
+  table->filled++;
+}
+
+/* Remember that the given message has been logged.  When memory is
+   exhausted, it may be logged again.
+   The caller must hold the lock.  */
+static void
+logged_insert (unsigned long int hash, const char *logfilename,
+               const char *domainname, const char *msgid1,
+               const char *msgid2)
+{
+  struct logged_table *table = logged_messages;
+  size_t logfilename_len = strlen (logfilename) + 1;
+  size_t domainname_len = strlen (domainname) + 1;
+  size_t msgid1_len = strlen (msgid1) + 1;
+  size_t msgid2_len = (msgid2 != NULL ? strlen (msgid2) + 1 : 0);
+  struct logged_message *message;
+  char *p;
+
+  /* Keep the table at most 3/4 full, so that the probe sequences stay
+     short.  */
+  if (table == NULL || 4 * (table->filled + 1) > 3 * table->size)
+    {
+      size_t new_size =
+        (table != NULL ? 2 * table->size : LOGGED_TABLE_INITIAL_SIZE);
+      struct logged_table *new_table =
+        (struct logged_table *)
+        calloc (1, offsetof (struct logged_table, slots)
+                   + new_size * sizeof (struct logged_message *));
+
+      if (new_table == NULL)
+        return;
+      new_table->size = new_size;
+      if (table != NULL)
+        {
+          size_t i;
+
+          for (i = 0; i < table->size; i++)
+            if (table->slots[i] != NULL)
+              logged_store (new_table, table->slots[i]);
+        }
+      /* Publish the new table.  */
+      ATOMIC_STORE_RELEASE (logged_messages, new_table);
+      table = new_table;
+    }
+
+  message =
+    (struct logged_message *)
+    malloc (offsetof (struct logged_message, contents)
+            + logfilename_len + domainname_len + msgid1_len + msgid2_len);
+  if (message == NULL)
+    return;
+  p = message->contents;
+  message->hash = hash;
+  message->logfilename = memcpy (p, logfilename, logfilename_len);
+  p += logfilename_len;
+  message->domainname = memcpy (p, domainname, domainname_len);
+  p += domainname_len;
+  message->msgid1 = memcpy (p, msgid1, msgid1_len);
+  p += msgid1_len;
+  message->msgid2 = (msgid2 != NULL ? memcpy (p, msgid2, msgid2_len) : NULL);
+
+  logged_store (table, message);
+}
 
 static inline void
 _nl_log_untranslated_locked (const char *logfilename, const char *domainname,
                              const char *msgid1, const char *msgid2, int plural)
 {
-  FILE *logfile;
   const char *separator;
 
   /* Can we reuse the last opened logfile?  */
@@ -73,6 +307,7 @@ _nl_log_untranslated_locked (const char *logfilename, const char *domainname,
       /* Close the last used logfile.  */
       if (last_logfilename != NULL)
         {
+          flush_pending ();
           if (last_logfile != NULL)
             {
               fclose (last_logfile);
@@ -90,37 +325,65 @@ _nl_log_untranslated_locked (const char *logfilename, const char *domainname,
       if (last_logfile == NULL)
         return;
     }
-  logfile = last_logfile;
+  if (last_logfile == NULL)
+    return;
 
-  fprintf (logfile, "domain ");
-  print_escaped (logfile, domainname, domainname + strlen (domainname));
+  append_string ("domain ");
+  append_escaped (domainname, domainname + strlen (domainname));
   separator = strchr (msgid1, MSGCTXT_SEPARATOR);
   if (separator != NULL)
     {
       /* The part before the MSGCTXT_SEPARATOR is the msgctxt.  */
-      fprintf (logfile, "\nmsgctxt ");
-      print_escaped (logfile, msgid1, separator);
+      append_string ("\nmsgctxt ");
+      append_escaped (msgid1, separator);
       msgid1 = separator + 1;
     }
-  fprintf (logfile, "\nmsgid ");
-  print_escaped (logfile, msgid1, msgid1 + strlen (msgid1));
+  append_string ("\nmsgid ");
+  append_escaped (msgid1, msgid1 + strlen (msgid1));
   if (plural)
     {
-      fprintf (logfile, "\nmsgid_plural ");
-      print_escaped (logfile, msgid2, msgid2 + strlen (msgid2));
-      fprintf (logfile, "\nmsgstr[0] \"\"\n");
+      append_string ("\nmsgid_plural ");
+      append_escaped (msgid2, msgid2 + strlen (msgid2));
+      append_string ("\nmsgstr[0] \"\"\n");
     }
   else
-    fprintf (logfile, "\nmsgstr \"\"\n");
-  putc ('\n', logfile);
+    append_string ("\nmsgstr \"\"\n");
+  append ("\n", 1);
+
+  if (pending_length >= LOG_BUFFER_SIZE)
+    flush_pending ();
 }
 
-/* Add to the log file an entry denoting a failed translation.  */
+/* Add to the log file an entry denoting a failed translation.  Each
+   message is logged once; the entries are collected in memory and written
+   when enough of them have accumulated, and at exit.  */
 void
 _nl_log_untranslated (const char *logfilename, const char *domainname,
                       const char *msgid1, const char *msgid2, int plural)
 {
+  const char *key2 = (plural ? msgid2 : NULL);
+  unsigned long int hash = logged_hash (domainname, msgid1, key2);
+
+#ifdef HAVE_LOCKFREE_READERS
+  /* Most untranslated messages are requested many times.  Recognize them
+     without taking the lock.  */
+  if (logged_find (ATOMIC_LOAD_ACQUIRE (logged_messages), hash,
+                   logfilename, domainname, msgid1, key2))
+    return;
+#endif
+
   __libc_lock_lock (lock);
-  _nl_log_untranslated_locked (logfilename, domainname, msgid1, msgid2, plural);
+  if (!logged_find (logged_messages, hash, logfilename, domainname, msgid1,
+                    key2))
+    {
+      if (!flush_registered)
+        flush_registered = (atexit (flush_at_exit) == 0 ? 1 : -1);
+      logged_insert (hash, logfilename, domainname, msgid1, key2);
+      _nl_log_untranslated_locked (logfilename, domainname, msgid1, msgid2,
+                                   plural);
+      /* Without a way to write the output at exit, write it now.  */
+      if (flush_registered < 0)
+        flush_pending ();
+    }
   __libc_lock_unlock (lock);
 }
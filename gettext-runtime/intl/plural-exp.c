@@ -20,6 +20,7 @@
 #endif
 
 #include <ctype.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -151,3 +152,416 @@ EXTRACT_PLURAL_EXPRESSION (const char *nullentry,
       *npluralsp = 2;
     }
 }
+
+
+/* Functions evaluating the well-known formulas, taken from the
+   documentation, node "Plural forms".  */
+
+static unsigned long int
+plural_one_form (unsigned long int n)
+{
+  return 0;
+}
+
+static unsigned long int
+plural_germanic (unsigned long int n)
+{
+  return n != 1;
+}
+
+static unsigned long int
+plural_french (unsigned long int n)
+{
+  return n > 1;
+}
+
+static unsigned long int
+plural_latvian (unsigned long int n)
+{
+  return (n % 10 == 1 && n % 100 != 11 ? 0 : n != 0 ? 1 : 2);
+}
+
+static unsigned long int
+plural_irish (unsigned long int n)
+{
+  return (n == 1 ? 0 : n == 2 ? 1 : 2);
+}
+
+static unsigned long int
+plural_romanian (unsigned long int n)
+{
+  return (n == 1 ? 0 : (n == 0 || (n % 100 > 0 && n % 100 < 20)) ? 1 : 2);
+}
+
+static unsigned long int
+plural_lithuanian (unsigned long int n)
+{
+  return (n % 10 == 1 && n % 100 != 11 ? 0
+	  : n % 10 >= 2 && (n % 100 < 10 || n % 100 >= 20) ? 1
+	  : 2);
+}
+
+static unsigned long int
+plural_slavic (unsigned long int n)
+{
+  return (n % 10 == 1 && n % 100 != 11 ? 0
+	  : n % 10 >= 2 && n % 10 <= 4 && (n % 100 < 10 || n % 100 >= 20) ? 1
+	  : 2);
+}
+
+static unsigned long int
+plural_czech (unsigned long int n)
+{
+  return (n == 1 ? 0 : n >= 2 && n <= 4 ? 1 : 2);
+}
+
+static unsigned long int
+plural_polish (unsigned long int n)
+{
+  return (n == 1 ? 0
+	  : n % 10 >= 2 && n % 10 <= 4 && (n % 100 < 10 || n % 100 >= 20) ? 1
+	  : 2);
+}
+
+static unsigned long int
+plural_slovenian (unsigned long int n)
+{
+  return (n % 100 == 1 ? 0
+	  : n % 100 == 2 ? 1
+	  : n % 100 == 3 || n % 100 == 4 ? 2
+	  : 3);
+}
+
+static unsigned long int
+plural_arabic (unsigned long int n)
+{
+  return (n == 0 ? 0
+	  : n == 1 ? 1
+	  : n == 2 ? 2
+	  : n % 100 >= 3 && n % 100 <= 10 ? 3
+	  : n % 100 >= 11 ? 4
+	  : 5);
+}
+
+static const struct plural_program plural_one_form_program =
+  { plural_one_form, { { PLURAL_OP_RETURN, 0 } } };
+static const struct plural_program plural_germanic_program =
+  { plural_germanic, { { PLURAL_OP_RETURN, 0 } } };
+static const struct plural_program plural_french_program =
+  { plural_french, { { PLURAL_OP_RETURN, 0 } } };
+static const struct plural_program plural_latvian_program =
+  { plural_latvian, { { PLURAL_OP_RETURN, 0 } } };
+static const struct plural_program plural_irish_program =
+  { plural_irish, { { PLURAL_OP_RETURN, 0 } } };
+static const struct plural_program plural_romanian_program =
+  { plural_romanian, { { PLURAL_OP_RETURN, 0 } } };
+static const struct plural_program plural_lithuanian_program =
+  { plural_lithuanian, { { PLURAL_OP_RETURN, 0 } } };
+static const struct plural_program plural_slavic_program =
+  { plural_slavic, { { PLURAL_OP_RETURN, 0 } } };
+static const struct plural_program plural_czech_program =
+  { plural_czech, { { PLURAL_OP_RETURN, 0 } } };
+static const struct plural_program plural_polish_program =
+  { plural_polish, { { PLURAL_OP_RETURN, 0 } } };
+static const struct plural_program plural_slovenian_program =
+  { plural_slovenian, { { PLURAL_OP_RETURN, 0 } } };
+static const struct plural_program plural_arabic_program =
+  { plural_arabic, { { PLURAL_OP_RETURN, 0 } } };
+
+/* The well-known formulas, without spaces and without enclosing
+   parentheses.  */
+static const struct
+{
+  const char *formula;
+  const struct plural_program *program;
+} plural_formulas[] =
+  {
+    { "0", &plural_one_form_program },
+    { "n!=1", &plural_germanic_program },
+    { "n>1", &plural_french_program },
+    { "n%10==1&&n%100!=11?0:n!=0?1:2", &plural_latvian_program },
+    { "n==1?0:n==2?1:2", &plural_irish_program },
+    { "n==1?0:(n==0||(n%100>0&&n%100<20))?1:2", &plural_romanian_program },
+    { "n%10==1&&n%100!=11?0:n%10>=2&&(n%100<10||n%100>=20)?1:2",
+      &plural_lithuanian_program },
+    { "n%10==1&&n%100!=11?0:n%10>=2&&n%10<=4&&(n%100<10||n%100>=20)?1:2",
+      &plural_slavic_program },
+    { "(n==1)?0:(n>=2&&n<=4)?1:2", &plural_czech_program },
+    { "n==1?0:n%10>=2&&n%10<=4&&(n%100<10||n%100>=20)?1:2",
+      &plural_polish_program },
+    { "n%100==1?0:n%100==2?1:n%100==3||n%100==4?2:3",
+      &plural_slovenian_program },
+    { "n==0?0:n==1?1:n==2?2:n%100>=3&&n%100<=10?3:n%100>=11?4:5",
+      &plural_arabic_program }
+  };
+
+/* Longer than any formula in plural_formulas, with enclosing parentheses
+   and a trailing NUL.  */
+#define PLURAL_FORMULA_MAX 80
+
+/* Look up the formula in the header entry NULLENTRY among the well-known
+   formulas.  The formula has been parsed successfully, therefore removing
+   the spaces in it doesn't change its meaning.  */
+static const struct plural_program *
+find_plural_formula (const char *nullentry)
+{
+  char buf[PLURAL_FORMULA_MAX];
+  const char *cp;
+  size_t len;
+  size_t i;
+
+  cp = strstr (nullentry, "plural=");
+  if (cp == NULL)
+    return NULL;
+  cp += 7;
+
+  /* Copy the formula, as far as the parser reads it, without spaces.  */
+  len = 0;
+  for (; *cp != '\0' && *cp != ';' && *cp != '\n'; cp++)
+    if (*cp != ' ' && *cp != '\t')
+      {
+	if (len == sizeof (buf) - 1)
+	  return NULL;
+	buf[len++] = *cp;
+      }
+  buf[len] = '\0';
+
+  for (i = 0; i < sizeof (plural_formulas) / sizeof (plural_formulas[0]); i++)
+    {
+      const char *formula = plural_formulas[i].formula;
+      size_t flen = strlen (formula);
+
+      if ((len == flen && memcmp (buf, formula, flen) == 0)
+	  || (len == flen + 2 && buf[0] == '(' && buf[len - 1] == ')'
+	      && memcmp (buf + 1, formula, flen) == 0))
+	return plural_formulas[i].program;
+    }
+  return NULL;
+}
+
+/* Return the number of instructions needed for EXP.  */
+static size_t
+plural_insn_count (const struct expression *exp)
+{
+  size_t count = 1;
+  int i;
+
+  for (i = 0; i < exp->nargs; i++)
+    count += plural_insn_count (exp->val.args[i]);
+  /* Jumps and conversions to boolean.  */
+  if (exp->nargs == 2 && (exp->operation == land || exp->operation == lor))
+    count++;
+  else if (exp->nargs == 3)
+    count++;
+  return count;
+}
+
+/* Return true if EXP always evaluates to 0 or 1.  */
+static int
+plural_is_boolean (const struct expression *exp)
+{
+  switch (exp->operation)
+    {
+    case lnot:
+    case less_than:
+    case greater_than:
+    case less_or_equal:
+    case greater_or_equal:
+    case equal:
+    case not_equal:
+    case land:
+    case lor:
+      return 1;
+    default:
+      return 0;
+    }
+}
+
+/* State of the compilation of a plural expression.  */
+struct plural_compiler
+{
+  struct plural_insn *insns;
+  size_t ninsns;
+  int depth;
+  int max_depth;
+};
+
+static void
+plural_emit (struct plural_compiler *pc, enum plural_opcode op,
+	     unsigned long int arg, int depth_change)
+{
+  pc->insns[pc->ninsns].op = op;
+  pc->insns[pc->ninsns].arg = arg;
+  pc->ninsns++;
+  pc->depth += depth_change;
+  if (pc->max_depth < pc->depth)
+    pc->max_depth = pc->depth;
+}
+
+/* Return the opcode of the binary operator OPERATION, taking both operands
+   from the stack.  */
+static enum plural_opcode
+plural_binary_opcode (enum expression_operator operation)
+{
+  switch (operation)
+    {
+    case mult:
+      return PLURAL_OP_MULT;
+    case divide:
+      return PLURAL_OP_DIVIDE;
+    case module:
+      return PLURAL_OP_MODULE;
+    case plus:
+      return PLURAL_OP_PLUS;
+    case minus:
+      return PLURAL_OP_MINUS;
+    case less_than:
+      return PLURAL_OP_LESS_THAN;
+    case greater_than:
+      return PLURAL_OP_GREATER_THAN;
+    case less_or_equal:
+      return PLURAL_OP_LESS_OR_EQUAL;
+    case greater_or_equal:
+      return PLURAL_OP_GREATER_OR_EQUAL;
+    case equal:
+      return PLURAL_OP_EQUAL;
+    default:
+      /* operation must be not_equal.  */
+      return PLURAL_OP_NOT_EQUAL;
+    }
+}
+
+/* Emit the instructions that push the value of EXP.  */
+static void
+plural_compile (struct plural_compiler *pc, const struct expression *exp)
+{
+  size_t jump;
+
+  switch (exp->nargs)
+    {
+    case 0:
+      if (exp->operation == var)
+	plural_emit (pc, PLURAL_OP_VAR, 0, 1);
+      else
+	plural_emit (pc, PLURAL_OP_NUM, exp->val.num, 1);
+      break;
+    case 1:
+      /* exp->operation must be lnot.  */
+      plural_compile (pc, exp->val.args[0]);
+      plural_emit (pc, PLURAL_OP_NOT, 0, 0);
+      break;
+    case 2:
+      if (exp->operation != land && exp->operation != lor
+	  && exp->val.args[1]->nargs == 0
+	  && exp->val.args[1]->operation == num)
+	{
+	  /* The right operand is a constant.  The _IMM and _VAR_IMM opcodes
+	     are in the same order as the others.  */
+	  enum plural_opcode op = plural_binary_opcode (exp->operation);
+
+	  if (exp->val.args[0]->nargs == 0
+	      && exp->val.args[0]->operation == var)
+	    plural_emit (pc,
+			 (enum plural_opcode)
+			 (op + (PLURAL_OP_MULT_VAR_IMM - PLURAL_OP_MULT)),
+			 exp->val.args[1]->val.num, 1);
+	  else
+	    {
+	      plural_compile (pc, exp->val.args[0]);
+	      plural_emit (pc,
+			   (enum plural_opcode)
+			   (op + (PLURAL_OP_MULT_IMM - PLURAL_OP_MULT)),
+			   exp->val.args[1]->val.num, 0);
+	    }
+	  break;
+	}
+
+      plural_compile (pc, exp->val.args[0]);
+      if (exp->operation == land || exp->operation == lor)
+	{
+	  /* Short-circuit evaluation.  */
+	  jump = pc->ninsns;
+	  plural_emit (pc, (exp->operation == land
+			    ? PLURAL_OP_AND_JUMP : PLURAL_OP_OR_JUMP),
+		       0, -1);
+	  plural_compile (pc, exp->val.args[1]);
+	  if (!plural_is_boolean (exp->val.args[1]))
+	    plural_emit (pc, PLURAL_OP_BOOL, 0, 0);
+	  pc->insns[jump].arg = pc->ninsns;
+	}
+      else
+	{
+	  plural_compile (pc, exp->val.args[1]);
+	  plural_emit (pc, plural_binary_opcode (exp->operation), 0, -1);
+	}
+      break;
+    case 3:
+      {
+	/* exp->operation must be qmop.  */
+	size_t skip;
+
+	plural_compile (pc, exp->val.args[0]);
+	jump = pc->ninsns;
+	plural_emit (pc, PLURAL_OP_POP_JUMP_IF_ZERO, 0, -1);
+	plural_compile (pc, exp->val.args[1]);
+	skip = pc->ninsns;
+	plural_emit (pc, PLURAL_OP_JUMP, 0, -1);
+	pc->insns[jump].arg = pc->ninsns;
+	plural_compile (pc, exp->val.args[2]);
+	pc->insns[skip].arg = pc->ninsns;
+      }
+      break;
+    }
+}
+
+const struct plural_program *
+internal_function
+COMPILE_PLURAL_EXPRESSION (const char *nullentry,
+			   const struct expression *plural)
+{
+  struct plural_program *prog;
+  struct plural_compiler pc;
+  size_t count;
+
+  if (plural == &GERMANIC_PLURAL)
+    return &plural_germanic_program;
+
+  if (nullentry != NULL)
+    {
+      const struct plural_program *known = find_plural_formula (nullentry);
+
+      if (known != NULL)
+	return known;
+    }
+
+  /* Lower the expression tree into a sequence of instructions.  */
+  count = plural_insn_count (plural) + 1;
+  prog = (struct plural_program *)
+    malloc (offsetof (struct plural_program, insns)
+	    + count * sizeof (struct plural_insn));
+  if (prog == NULL)
+    return NULL;
+  prog->eval = NULL;
+
+  pc.insns = prog->insns;
+  pc.ninsns = 0;
+  pc.depth = 0;
+  pc.max_depth = 0;
+  plural_compile (&pc, plural);
+  plural_emit (&pc, PLURAL_OP_RETURN, 0, 0);
+
+  if (pc.max_depth > PLURAL_STACK_SIZE)
+    {
+      free (prog);
+      return NULL;
+    }
+  return prog;
+}
+
+void
+internal_function
+FREE_PLURAL_PROGRAM (const struct plural_program *prog)
+{
+  if (prog != NULL && prog->eval == NULL)
+    free ((struct plural_program *) prog);
+}
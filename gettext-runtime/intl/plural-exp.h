@@ -69,6 +69,82 @@ struct expression
   } val;
 };
 
+/* Instructions of a compiled plural expression.  They operate on a stack
+   of unsigned long int values.  */
+enum plural_opcode
+{
+  PLURAL_OP_VAR,		/* Push "n".  */
+  PLURAL_OP_NUM,		/* Push the argument.  */
+  PLURAL_OP_NOT,		/* Replace the top with its logical NOT.  */
+  PLURAL_OP_BOOL,		/* Replace the top with 1 if it is non-zero.  */
+  /* Binary operators, taking both operands from the stack:  */
+  PLURAL_OP_MULT,
+  PLURAL_OP_DIVIDE,
+  PLURAL_OP_MODULE,
+  PLURAL_OP_PLUS,
+  PLURAL_OP_MINUS,
+  PLURAL_OP_LESS_THAN,
+  PLURAL_OP_GREATER_THAN,
+  PLURAL_OP_LESS_OR_EQUAL,
+  PLURAL_OP_GREATER_OR_EQUAL,
+  PLURAL_OP_EQUAL,
+  PLURAL_OP_NOT_EQUAL,
+  /* The same binary operators, with the argument as right operand:  */
+  PLURAL_OP_MULT_IMM,
+  PLURAL_OP_DIVIDE_IMM,
+  PLURAL_OP_MODULE_IMM,
+  PLURAL_OP_PLUS_IMM,
+  PLURAL_OP_MINUS_IMM,
+  PLURAL_OP_LESS_THAN_IMM,
+  PLURAL_OP_GREATER_THAN_IMM,
+  PLURAL_OP_LESS_OR_EQUAL_IMM,
+  PLURAL_OP_GREATER_OR_EQUAL_IMM,
+  PLURAL_OP_EQUAL_IMM,
+  PLURAL_OP_NOT_EQUAL_IMM,
+  /* The same binary operators, with "n" as left operand and the argument
+     as right operand, pushing the result:  */
+  PLURAL_OP_MULT_VAR_IMM,
+  PLURAL_OP_DIVIDE_VAR_IMM,
+  PLURAL_OP_MODULE_VAR_IMM,
+  PLURAL_OP_PLUS_VAR_IMM,
+  PLURAL_OP_MINUS_VAR_IMM,
+  PLURAL_OP_LESS_THAN_VAR_IMM,
+  PLURAL_OP_GREATER_THAN_VAR_IMM,
+  PLURAL_OP_LESS_OR_EQUAL_VAR_IMM,
+  PLURAL_OP_GREATER_OR_EQUAL_VAR_IMM,
+  PLURAL_OP_EQUAL_VAR_IMM,
+  PLURAL_OP_NOT_EQUAL_VAR_IMM,
+  /* Control flow.  The argument is the index of the target instruction.  */
+  PLURAL_OP_AND_JUMP,		/* If the top is zero, jump, else pop.  */
+  PLURAL_OP_OR_JUMP,		/* If the top is non-zero, replace it with 1
+				   and jump, else pop.  */
+  PLURAL_OP_POP_JUMP_IF_ZERO,	/* Pop, and jump if the value was zero.  */
+  PLURAL_OP_JUMP,		/* Jump.  */
+  PLURAL_OP_RETURN		/* Return the top.  */
+};
+
+struct plural_insn
+{
+  enum plural_opcode op;
+  unsigned long int arg;
+};
+
+/* The maximum stack depth of compiled plural expressions.  Expressions
+   that need more are evaluated through plural_eval.  */
+#define PLURAL_STACK_SIZE 32
+
+/* This is the representation of a plural expression prepared for fast
+   evaluation, either through a function specialized for a well-known
+   formula, or through a sequence of instructions.  */
+struct plural_program
+{
+  /* The function evaluating a well-known formula, or NULL.  Programs with
+     such a function are statically allocated.  */
+  unsigned long int (*eval) (unsigned long int n);
+  /* Otherwise, the instructions, ending with PLURAL_OP_RETURN.  */
+  struct plural_insn insns[1];
+};
+
 /* This is the data structure to pass information to the parser and get
    the result in a thread-safe way.  */
 struct parse_args
@@ -93,16 +169,22 @@ struct parse_args
 # define PLURAL_PARSE __gettextparse
 # define GERMANIC_PLURAL __gettext_germanic_plural
 # define EXTRACT_PLURAL_EXPRESSION __gettext_extract_plural
+# define COMPILE_PLURAL_EXPRESSION __gettext_compile_plural
+# define FREE_PLURAL_PROGRAM __gettext_free_plural_program
 #elif defined (IN_LIBINTL)
 # define FREE_EXPRESSION libintl_gettext_free_exp
 # define PLURAL_PARSE libintl_gettextparse
 # define GERMANIC_PLURAL libintl_gettext_germanic_plural
 # define EXTRACT_PLURAL_EXPRESSION libintl_gettext_extract_plural
+# define COMPILE_PLURAL_EXPRESSION libintl_gettext_compile_plural
+# define FREE_PLURAL_PROGRAM libintl_gettext_free_plural_program
 #else
 # define FREE_EXPRESSION free_plural_expression
 # define PLURAL_PARSE parse_plural_expression
 # define GERMANIC_PLURAL germanic_plural
 # define EXTRACT_PLURAL_EXPRESSION extract_plural_expression
+# define COMPILE_PLURAL_EXPRESSION compile_plural_expression
+# define FREE_PLURAL_PROGRAM free_plural_program
 #endif
 
 extern void FREE_EXPRESSION (struct expression *exp)
@@ -113,10 +195,21 @@ extern void EXTRACT_PLURAL_EXPRESSION (const char *nullentry,
 				       const struct expression **pluralp,
 				       unsigned long int *npluralsp)
      internal_function;
+/* Prepare PLURAL, as returned by EXTRACT_PLURAL_EXPRESSION for the header
+   entry NULLENTRY, for fast evaluation.  Returns NULL if PLURAL should be
+   evaluated through plural_eval instead.  */
+extern const struct plural_program *
+       COMPILE_PLURAL_EXPRESSION (const char *nullentry,
+				  const struct expression *plural)
+     internal_function;
+extern void FREE_PLURAL_PROGRAM (const struct plural_program *prog)
+     internal_function;
 
 #if !defined (_LIBC) && !defined (IN_LIBINTL) && !defined (IN_LIBGLOCALE)
 extern unsigned long int plural_eval (const struct expression *pexp,
 				      unsigned long int n);
+extern unsigned long int plural_program_eval (const struct plural_program *prog,
+					      unsigned long int n);
 #endif
 
 
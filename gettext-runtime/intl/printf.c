@@ -82,6 +82,203 @@ char *alloca ();
 /* Define auxiliary functions declared in "printf-parse.h".  */
 #include "printf-parse.c"
 
+/* The format strings with positions are nearly always translations, which
+   stay in place and unchanged while the program runs, and the same ones
+   are used again and again.  Therefore the results of printf_parse are
+   remembered, in a direct-mapped table indexed by the address and the
+   length of the format string.  Since the caller may also pass a format
+   string in a buffer that it later reuses, an entry is only used if the
+   format string still has the contents it had when it was parsed.  A format
+   string that maps to an occupied entry replaces it, unless that entry was
+   created or used since the last such collision.
+   Without a lock, a thread takes an entry out of the table while it uses
+   it, and puts it back afterwards, so that no other thread can free it in
+   the meantime.  */
+#if (defined __GNUC__ \
+     && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))) \
+    || defined __clang__
+
+/* Number of entries of the cache of parsed format strings, a power of 2.  */
+# define PARSED_FORMATS_BITS 8
+# define PARSED_FORMATS_SIZE (1 << PARSED_FORMATS_BITS)
+
+/* A parsed format string.  */
+struct parsed_format
+{
+  /* The address of the format string.  */
+  const char *format;
+  /* Its length.  */
+  size_t length;
+  /* Nonzero if the entry was created or used since another format string
+     mapped to it.  */
+  int referenced;
+  /* A copy of its contents.  */
+  const char *contents;
+  /* The directives, pointing into FORMAT.  */
+  size_t count;
+  char_directive *dir;
+  size_t max_width_length;
+  size_t max_precision_length;
+  /* The types of the arguments.  */
+  size_t arg_count;
+  arg_type *arg_types;
+};
+
+static struct parsed_format *parsed_formats[PARSED_FORMATS_SIZE];
+
+/* Return the index in parsed_formats of FORMAT, of length LENGTH.  */
+static inline size_t
+parsed_format_index (const char *format, size_t length)
+{
+  /* Multiplicative hashing: the top bits of the product depend on all bits
+     of the address.  */
+  size_t h = ((size_t) format + length) * (size_t) 0x9e3779b97f4a7c15ULL;
+
+  return h >> (sizeof (size_t) * CHAR_BIT - PARSED_FORMATS_BITS);
+}
+
+/* Return an entry with the result D, A of parsing FORMAT, of length
+   LENGTH, or NULL if memory is exhausted.  */
+static struct parsed_format *
+parsed_format_new (const char *format, size_t length,
+                   const char_directives *d, const arguments *a)
+{
+  struct parsed_format *entry =
+    (struct parsed_format *)
+    malloc (sizeof (struct parsed_format)
+            + (d->count + 1) * sizeof (char_directive)
+            + a->count * sizeof (arg_type)
+            + length + 1);
+  char *p;
+  size_t i;
+
+  if (entry == NULL)
+    return NULL;
+  p = (char *) (entry + 1);
+  entry->format = format;
+  entry->length = length;
+  entry->referenced = 1;
+  entry->count = d->count;
+  entry->dir = (char_directive *) p;
+  memcpy (entry->dir, d->dir, (d->count + 1) * sizeof (char_directive));
+  p += (d->count + 1) * sizeof (char_directive);
+  entry->max_width_length = d->max_width_length;
+  entry->max_precision_length = d->max_precision_length;
+  entry->arg_count = a->count;
+  entry->arg_types = (arg_type *) p;
+  for (i = 0; i < a->count; i++)
+    entry->arg_types[i] = a->arg[i].type;
+  p += a->count * sizeof (arg_type);
+  memcpy (p, format, length + 1);
+  entry->contents = p;
+  return entry;
+}
+
+/* Store ENTRY in parsed_formats at index IDX, unless another thread did
+   so with another entry in the meantime.  */
+static void
+parsed_format_put (size_t idx, struct parsed_format *entry)
+{
+  struct parsed_format *expected = NULL;
+
+  if (!__atomic_compare_exchange_n (&parsed_formats[idx], &expected, entry,
+                                    0, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    free (entry);
+}
+
+/* Store the result of parsing in ENTRY in D, A.  Return 0, or -1 if
+   memory is exhausted.  */
+static int
+parsed_format_get (const struct parsed_format *entry, char_directives *d,
+                   arguments *a)
+{
+  size_t i;
+
+  d->count = entry->count;
+  if (d->count < N_DIRECT_ALLOC_DIRECTIVES)
+    d->dir = d->direct_alloc_dir;
+  else
+    {
+      d->dir =
+        (char_directive *) malloc ((d->count + 1) * sizeof (char_directive));
+      if (d->dir == NULL)
+        return -1;
+    }
+  memcpy (d->dir, entry->dir, (d->count + 1) * sizeof (char_directive));
+  d->max_width_length = entry->max_width_length;
+  d->max_precision_length = entry->max_precision_length;
+
+  a->count = entry->arg_count;
+  if (a->count <= N_DIRECT_ALLOC_ARGUMENTS)
+    a->arg = a->direct_alloc_arg;
+  else
+    {
+      a->arg = (argument *) malloc (a->count * sizeof (argument));
+      if (a->arg == NULL)
+        {
+          if (d->dir != d->direct_alloc_dir)
+            free (d->dir);
+          return -1;
+        }
+    }
+  for (i = 0; i < a->count; i++)
+    a->arg[i].type = entry->arg_types[i];
+  return 0;
+}
+
+/* Like printf_parse, but use the remembered result for FORMAT if possible.  */
+static int
+printf_parse_cached (const char *format, char_directives *d, arguments *a)
+{
+  size_t length = strlen (format);
+  size_t idx = parsed_format_index (format, length);
+  struct parsed_format *entry =
+    __atomic_exchange_n (&parsed_formats[idx], NULL, __ATOMIC_ACQUIRE);
+  struct parsed_format *new_entry;
+
+  if (entry != NULL && entry->format == format && entry->length == length
+      && memcmp (entry->contents, format, length) == 0)
+    {
+      int ret = parsed_format_get (entry, d, a);
+
+      entry->referenced = 1;
+      parsed_format_put (idx, entry);
+      if (ret < 0)
+        errno = ENOMEM;
+      return ret;
+    }
+
+  if (printf_parse (format, d, a) < 0)
+    {
+      int saved_errno = errno;
+
+      if (entry != NULL)
+        parsed_format_put (idx, entry);
+      errno = saved_errno;
+      return -1;
+    }
+  if (entry != NULL && entry->referenced)
+    {
+      /* Give the entry of the other format string a second chance.  */
+      entry->referenced = 0;
+      parsed_format_put (idx, entry);
+      return 0;
+    }
+  /* Replace the entry of the other format string, if any.  */
+  new_entry = parsed_format_new (format, length, d, a);
+  if (new_entry != NULL)
+    {
+      free (entry);
+      entry = new_entry;
+    }
+  if (entry != NULL)
+    parsed_format_put (idx, entry);
+  return 0;
+}
+
+# define PRINTF_PARSE_CACHED printf_parse_cached
+#endif
+
 /* Define functions declared in "vasnprintf.h".  */
 #define vasnprintf libintl_vasnprintf
 #include "vasnprintf.c"
@@ -57,6 +57,47 @@
 /* Lock variable to protect the global data in the gettext implementation.  */
 gl_rwlock_define (extern, _nl_state_lock attribute_hidden)
 
+#ifdef HAVE_LOCKFREE_READERS
+/* When HAVE_LOCKFREE_READERS, gettext() reads _nl_current_default_domain
+   without taking _nl_state_lock, and may still be using an old value.
+   Therefore the values are not freed while the program runs.  Instead,
+   each domain name is allocated once, and reused when it is set again, so
+   that the memory only grows with the number of distinct names.  */
+struct default_domain
+{
+  struct default_domain *next;
+  char name[ZERO];
+};
+
+/* The domain names that were allocated by textdomain().
+   Protected by _nl_state_lock.  */
+static struct default_domain *default_domains;
+
+/* Return the copy of DOMAINNAME in default_domains, adding it if needed,
+   or NULL if memory was exhausted.
+   The caller must hold _nl_state_lock for writing.  */
+static char *
+intern_default_domain (const char *domainname)
+{
+  struct default_domain *p;
+  size_t len;
+
+  for (p = default_domains; p != NULL; p = p->next)
+    if (strcmp (p->name, domainname) == 0)
+      return p->name;
+
+  len = strlen (domainname) + 1;
+  p = (struct default_domain *)
+      malloc (offsetof (struct default_domain, name) + len);
+  if (p == NULL)
+    return NULL;
+  memcpy (p->name, domainname, len);
+  p->next = default_domains;
+  default_domains = p;
+  return p->name;
+}
+#endif
+
 /* Set the current default message catalog to DOMAINNAME.
    If DOMAINNAME is null, return the current default.
    If DOMAINNAME is "", reset to the default of "messages".  */
@@ -78,8 +119,9 @@ TEXTDOMAIN (const char *domainname)
   if (domainname[0] == '\0'
       || strcmp (domainname, _nl_default_default_domain) == 0)
     {
-      _nl_current_default_domain = _nl_default_default_domain;
-      new_domain = (char *) _nl_current_default_domain;
+      ATOMIC_STORE_RELEASE (_nl_current_default_domain,
+			    _nl_default_default_domain);
+      new_domain = (char *) _nl_default_default_domain;
     }
   else if (strcmp (domainname, old_domain) == 0)
     /* This can happen and people will use it to signal that some
@@ -90,7 +132,9 @@ TEXTDOMAIN (const char *domainname)
       /* If the following malloc fails `_nl_current_default_domain'
 	 will be NULL.  This value will be returned and so signals we
 	 are out of core.  */
-#if defined _LIBC || defined HAVE_STRDUP
+#ifdef HAVE_LOCKFREE_READERS
+      new_domain = intern_default_domain (domainname);
+#elif defined _LIBC || defined HAVE_STRDUP
       new_domain = strdup (domainname);
 #else
       size_t len = strlen (domainname) + 1;
@@ -100,7 +144,7 @@ TEXTDOMAIN (const char *domainname)
 #endif
 
       if (new_domain != NULL)
-	_nl_current_default_domain = new_domain;
+	ATOMIC_STORE_RELEASE (_nl_current_default_domain, new_domain);
     }
 
   /* We use this possibility to signal a change of the loaded catalogs
@@ -110,8 +154,10 @@ TEXTDOMAIN (const char *domainname)
     {
       ++_nl_msg_cat_cntr;
 
+#ifndef HAVE_LOCKFREE_READERS
       if (old_domain != new_domain && old_domain != _nl_default_default_domain)
 	free (old_domain);
+#endif
     }
 
   gl_rwlock_unlock (_nl_state_lock);
@@ -122,4 +168,24 @@ TEXTDOMAIN (const char *domainname)
 #ifdef _LIBC
 /* Alias for function name in GNU C Library.  */
 weak_alias (__textdomain, textdomain);
+
+/* This is called from dcigettext.c's free_mem.  */
+void __libc_freeres_fn_section
+_nl_textdomain_subfreeres ()
+{
+# ifdef HAVE_LOCKFREE_READERS
+  while (default_domains != NULL)
+    {
+      struct default_domain *next = default_domains->next;
+
+      free (default_domains);
+      default_domains = next;
+    }
+# else
+  if (_nl_current_default_domain != _nl_default_default_domain)
+    /* Yes, this is a pointer comparison.  */
+    free ((char *) _nl_current_default_domain);
+# endif
+  _nl_current_default_domain = _nl_default_default_domain;
+}
 #endif
@@ -27,6 +27,8 @@
                         format string.  Depends on FCHAR_T.
      PRINTF_PARSE       Function that parses a format string.
                         Depends on FCHAR_T.
+     PRINTF_PARSE_CACHED Optional.  Function like PRINTF_PARSE that may
+                        reuse the result of an earlier call.
      DCHAR_CPY          memcpy like function for DCHAR_T[] arrays.
      DCHAR_SET          memset like function for DCHAR_T[] arrays.
      DCHAR_MBSNLEN      mbsnlen like function for DCHAR_T[] arrays.
@@ -1776,7 +1778,11 @@ VASNPRINTF (DCHAR_T *resultbuf, size_t *lengthp,
   DIRECTIVES d;
   arguments a;
 
+#ifdef PRINTF_PARSE_CACHED
+  if (PRINTF_PARSE_CACHED (format, &d, &a) < 0)
+#else
   if (PRINTF_PARSE (format, &d, &a) < 0)
+#endif
     /* errno is already set.  */
     return NULL;
 
@@ -1867,6 +1873,16 @@ VASNPRINTF (DCHAR_T *resultbuf, size_t *lengthp,
         result = memory;                                                     \
       }
 
+    /* Start with room for the format string and a few characters per
+       directive, rather than growing the result from a dozen characters.  */
+    if (result == NULL)
+      {
+        size_t estimate =
+          xsum (d.dir[d.count].dir_start - format, xtimes (d.count, 16));
+
+        ENSURE_ALLOCATION (estimate);
+      }
+
     for (cp = format, i = 0, dp = &d.dir[0]; ; cp = dp->dir_end, i++, dp++)
       {
         if (cp != dp->dir_start)
@@ -4600,6 +4616,85 @@ VASNPRINTF (DCHAR_T *resultbuf, size_t *lengthp,
                   length += count;
                 }
               }
+#endif
+#if !WIDE_CHAR_VERSION && !ENABLE_UNISTDIO
+            else if (dp->flags == 0
+                     && dp->width_start == dp->width_end
+                     && dp->precision_start == dp->precision_end
+                     && ((dp->conversion == 's'
+                          && a.arg[dp->arg_index].type == TYPE_STRING
+                          && a.arg[dp->arg_index].a.a_string != NULL)
+                         || ((dp->conversion == 'd' || dp->conversion == 'i')
+                             && (a.arg[dp->arg_index].type == TYPE_INT
+                                 || a.arg[dp->arg_index].type == TYPE_LONGINT))
+                         || (dp->conversion == 'u'
+                             && (a.arg[dp->arg_index].type == TYPE_UINT
+                                 || a.arg[dp->arg_index].type == TYPE_ULONGINT))))
+              {
+                /* A plain %s, %d, %i or %u directive, possibly with a size
+                   modifier and an argument position.  Format it here, since
+                   going through SNPRINTF is much slower.  */
+                if (dp->conversion == 's')
+                  {
+                    const char *arg = a.arg[dp->arg_index].a.a_string;
+                    size_t n = strlen (arg);
+
+                    ENSURE_ALLOCATION (xsum (length, n));
+                    memcpy (result + length, arg, n);
+                    length += n;
+                  }
+                else
+                  {
+                    /* Room for the digits of an unsigned long in base 10,
+                       and for the sign.  */
+                    char digits[3 * sizeof (unsigned long) + 1];
+                    char *p = digits + sizeof (digits);
+                    unsigned long value;
+                    int negative = 0;
+                    size_t n;
+
+                    switch (a.arg[dp->arg_index].type)
+                      {
+                      case TYPE_INT:
+                        {
+                          int arg = a.arg[dp->arg_index].a.a_int;
+                          negative = (arg < 0);
+                          value = (negative
+                                   ? - (unsigned long) arg
+                                   : (unsigned long) arg);
+                        }
+                        break;
+                      case TYPE_LONGINT:
+                        {
+                          long int arg = a.arg[dp->arg_index].a.a_longint;
+                          negative = (arg < 0);
+                          value = (negative
+                                   ? - (unsigned long) arg
+                                   : (unsigned long) arg);
+                        }
+                        break;
+                      case TYPE_UINT:
+                        value = a.arg[dp->arg_index].a.a_uint;
+                        break;
+                      default: /* TYPE_ULONGINT */
+                        value = a.arg[dp->arg_index].a.a_ulongint;
+                        break;
+                      }
+                    do
+                      {
+                        *--p = '0' + value % 10;
+                        value = value / 10;
+                      }
+                    while (value > 0);
+                    if (negative)
+                      *--p = '-';
+                    n = digits + sizeof (digits) - p;
+
+                    ENSURE_ALLOCATION (xsum (length, n));
+                    memcpy (result + length, p, n);
+                    length += n;
+                  }
+              }
 #endif
             else
               {
@@ -5596,6 +5691,7 @@ VASNPRINTF (DCHAR_T *resultbuf, size_t *lengthp,
 #undef USE_SNPRINTF
 #undef DCHAR_SET
 #undef DCHAR_CPY
+#undef PRINTF_PARSE_CACHED
 #undef PRINTF_PARSE
 #undef DIRECTIVES
 #undef DIRECTIVE
@@ -1,5 +1,5 @@
 /* Class autosprintf - formatted output to an ostream.
-   Copyright (C) 2002, 2013 Free Software Foundation, Inc.
+   Copyright (C) 2002, 2013, 2026 Free Software Foundation, Inc.
    Written by Bruno Haible <bruno@clisp.org>, 2002.
 
    This program is free software: you can redistribute it and/or modify
@@ -25,6 +25,7 @@
 /* Specification.  */
 #include "autosprintf.h"
 
+#include <limits.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
@@ -40,33 +41,85 @@
 namespace gnu
 {
 
+  /* Formats FORMAT and ARGS into BUF, of size BUFSIZE, if the result fits
+     there, otherwise into freshly malloc()ed memory.  Returns the result
+     and stores its length, excluding the trailing NUL, in *LENGTHP.
+     Returns NULL upon error.  */
+  static char *
+  format_into (char *buf, size_t bufsize, size_t *lengthp,
+               const char *format, va_list args)
+  {
+    /* vasnprintf() fills BUF in a single pass and continues in the heap if
+       BUF is too small, whereas a vsnprintf() into BUF would need a second
+       pass, and a slow one in some libc versions.  */
+    size_t length = bufsize;
+    char *result = vasnprintf (buf, &length, format, args);
+
+    if (result == NULL)
+      return NULL;
+    *lengthp = length;
+    return result;
+  }
+
   /* Constructor: takes a format string and the printf arguments.  */
   autosprintf::autosprintf (const char *format, ...)
   {
     va_list args;
     va_start (args, format);
-    if (vasprintf (&str, format, args) < 0)
-      str = NULL;
+    str = format_into (buf, sizeof (buf), &len, format, args);
+    if (str == NULL)
+      len = 0;
     va_end (args);
   }
 
   /* Copy constructor.  Necessary because the destructor is nontrivial.  */
   autosprintf::autosprintf (const autosprintf& src)
   {
-    str = (src.str != NULL ? strdup (src.str) : NULL);
+    len = src.len;
+    if (src.str == NULL)
+      str = NULL;
+    else
+      {
+        str = (len < sizeof (buf) ? buf : (char *) malloc (len + 1));
+        if (str != NULL)
+          memcpy (str, src.str, len + 1);
+        else
+          len = 0;
+      }
   }
 
-  /* Copy constructor.  Necessary because the destructor is nontrivial.  */
+  /* Assignment, through copy-and-swap.  Necessary because the destructor is
+     nontrivial.  */
   autosprintf& autosprintf::operator = (autosprintf copy)
   {
-    std::swap (copy.str, this->str);
+    if (copy.str == copy.buf)
+      {
+        if (str != buf)
+          free (str);
+        memcpy (buf, copy.buf, copy.len + 1);
+        str = buf;
+        len = copy.len;
+      }
+    else
+      {
+        if (str == buf)
+          {
+            /* Leave COPY with nothing to free.  */
+            str = copy.str;
+            copy.str = NULL;
+          }
+        else
+          std::swap (copy.str, this->str);
+        len = copy.len;
+      }
     return *this;
   }
 
   /* Destructor: frees the temporarily allocated string.  */
   autosprintf::~autosprintf ()
   {
-    free (str);
+    if (str != buf)
+      free (str);
   }
 
   /* Conversion to string.  */
@@ -74,9 +127,8 @@ namespace gnu
   {
     if (str != NULL)
       {
-        size_t length = strlen (str) + 1;
-        char *copy = new char[length];
-        memcpy (copy, str, length);
+        char *copy = new char[len + 1];
+        memcpy (copy, str, len + 1);
         return copy;
       }
     else
@@ -84,6 +136,55 @@ namespace gnu
   }
   autosprintf::operator std::string () const
   {
-    return std::string (str ? str : "(error in autosprintf)");
+    return (str ? std::string (str, len) : std::string ("(error in autosprintf)"));
+  }
+
+  /* Appends the printf output of FORMAT and the arguments to RESULT.  */
+  int sprintf_append (std::string& result, const char *format, ...)
+  {
+    char buf[256];
+    va_list args;
+    size_t length;
+    char *output;
+
+    va_start (args, format);
+    output = format_into (buf, sizeof (buf), &length, format, args);
+    va_end (args);
+    if (output == NULL || length > INT_MAX)
+      {
+        if (output != NULL && output != buf)
+          free (output);
+        return -1;
+      }
+    result.append (output, length);
+    if (output != buf)
+      free (output);
+    return length;
+  }
+
+  /* Writes the printf output of FORMAT and the arguments to STREAM.  */
+  int ostream_printf (std::ostream& stream, const char *format, ...)
+  {
+    /* Large enough for most messages, so that they go from the stack to the
+       stream buffer.  */
+    char buf[1024];
+    va_list args;
+    size_t length;
+    char *output;
+
+    va_start (args, format);
+    output = format_into (buf, sizeof (buf), &length, format, args);
+    va_end (args);
+    if (output == NULL || length > INT_MAX)
+      {
+        if (output != NULL && output != buf)
+          free (output);
+        stream.setstate (std::ios_base::failbit);
+        return -1;
+      }
+    stream.write (output, length);
+    if (output != buf)
+      free (output);
+    return length;
   }
 }
@@ -1,5 +1,5 @@
 /* Class autosprintf - formatted output to an ostream.
-   Copyright (C) 2002, 2012, 2013 Free Software Foundation, Inc.
+   Copyright (C) 2002, 2012, 2013, 2026 Free Software Foundation, Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU Lesser General Public License as published by
@@ -32,8 +32,12 @@
 # endif
 #endif
 
+#include <string.h>
 #include <string>
 #include <iostream>
+#if __cplusplus >= 201703L
+# include <string_view>
+#endif
 
 namespace gnu
 {
@@ -47,21 +51,69 @@ namespace gnu
                 _AUTOSPRINTF_ATTRIBUTE_FORMAT();
     /* Copy constructor.  */
     autosprintf (const autosprintf& src);
+#if __cplusplus >= 201103L
+    /* Move constructor.  Takes over the heap allocated string of SRC, if
+       any, and leaves SRC in the error state.  */
+    autosprintf (autosprintf&& src) noexcept
+      : str (src.str), len (src.len)
+    {
+      if (src.str == src.buf)
+        {
+          memcpy (buf, src.buf, len + 1);
+          str = buf;
+        }
+      src.str = NULL;
+      src.len = 0;
+    }
+#endif
+    /* Assignment.  Moves from a temporary in C++11.  */
     autosprintf& operator = (autosprintf copy);
     /* Destructor: frees the temporarily allocated string.  */
     ~autosprintf ();
     /* Conversion to string.  */
     operator char * () const;
     operator std::string () const;
+    /* Access to the string, without copying it.  */
+    const char *c_str () const
+    {
+      return (str ? str : "(error in autosprintf)");
+    }
+#if __cplusplus >= 201703L
+    operator std::string_view () const
+    {
+      return (str
+              ? std::string_view (str, len)
+              : std::string_view ("(error in autosprintf)"));
+    }
+#endif
     /* Output to an ostream.  */
     friend inline std::ostream& operator<< (std::ostream& stream, const autosprintf& tmp)
     {
-      stream << (tmp.str ? tmp.str : "(error in autosprintf)");
+      if (tmp.str)
+        stream.write (tmp.str, tmp.len);
+      else
+        stream << "(error in autosprintf)";
       return stream;
     }
   private:
+    /* The formatted string, or NULL after an error.  Points to buf if the
+       string is short enough.  */
     char *str;
+    /* The length of str, excluding the trailing NUL.  */
+    size_t len;
+    char buf[128 - sizeof (char *) - sizeof (size_t)];
   };
+
+  /* Appends the printf output of FORMAT and the arguments to RESULT.
+     Returns the number of bytes appended, or -1 upon error.  */
+  extern int sprintf_append (std::string& result, const char *format, ...)
+             _AUTOSPRINTF_ATTRIBUTE_FORMAT();
+
+  /* Writes the printf output of FORMAT and the arguments to STREAM, without
+     creating an autosprintf object.  Returns the number of bytes written,
+     or -1 upon error.  */
+  extern int ostream_printf (std::ostream& stream, const char *format, ...)
+             _AUTOSPRINTF_ATTRIBUTE_FORMAT();
 }
 
 #endif /* _AUTOSPRINTF_H */
@@ -1,5 +1,5 @@
 /* Library functions for class autosprintf.
-   Copyright (C) 2002-2003, 2006 Free Software Foundation, Inc.
+   Copyright (C) 2002-2003, 2006, 2026 Free Software Foundation, Inc.
    Written by Bruno Haible <bruno@clisp.org>, 2002.
 
    This program is free software: you can redistribute it and/or modify
@@ -17,7 +17,8 @@
 
 #include <config.h>
 
-#if !(HAVE_VASPRINTF && HAVE_POSIX_PRINTF)
+/* Specification.  */
+#include "lib-asprintf.h"
 
 #define STATIC static
 
@@ -29,6 +30,9 @@
 
 /* Define functions declared in "vasnprintf.h".  */
 #include "vasnprintf.c"
+
+#if !(HAVE_VASPRINTF && HAVE_POSIX_PRINTF)
+
 #include "asnprintf.c"
 
 /* Define functions declared in "vasprintf.h".  */
@@ -1,5 +1,5 @@
 /* Library functions for class autosprintf.
-   Copyright (C) 2002-2003 Free Software Foundation, Inc.
+   Copyright (C) 2002-2003, 2026 Free Software Foundation, Inc.
    Written by Bruno Haible <bruno@clisp.org>, 2002.
 
    This program is free software: you can redistribute it and/or modify
@@ -24,9 +24,17 @@
 /* Get asprintf(), vasprintf() declarations.  */
 #include <stdio.h>
 
+/* This library contains its own vasnprintf() nevertheless, because it can
+   format into a buffer provided by the caller.  Give it a name that does
+   not clash with other libraries.  */
+#define vasnprintf libasprintf_vasnprintf
+
 #else
 
 /* Get asprintf(), vasprintf() declarations.  */
 #include "vasprintf.h"
 
 #endif
+
+/* Get vasnprintf() declaration.  */
+#include "vasnprintf.h"
@@ -1867,6 +1867,16 @@ VASNPRINTF (DCHAR_T *resultbuf, size_t *lengthp,
         result = memory;                                                     \
       }
 
+    /* Start with room for the format string and a few characters per
+       directive, rather than growing the result from a dozen characters.  */
+    if (result == NULL)
+      {
+        size_t estimate =
+          xsum (d.dir[d.count].dir_start - format, xtimes (d.count, 16));
+
+        ENSURE_ALLOCATION (estimate);
+      }
+
     for (cp = format, i = 0, dp = &d.dir[0]; ; cp = dp->dir_end, i++, dp++)
       {
         if (cp != dp->dir_start)
@@ -4600,6 +4610,85 @@ VASNPRINTF (DCHAR_T *resultbuf, size_t *lengthp,
                   length += count;
                 }
               }
+#endif
+#if !WIDE_CHAR_VERSION && !ENABLE_UNISTDIO
+            else if (dp->flags == 0
+                     && dp->width_start == dp->width_end
+                     && dp->precision_start == dp->precision_end
+                     && ((dp->conversion == 's'
+                          && a.arg[dp->arg_index].type == TYPE_STRING
+                          && a.arg[dp->arg_index].a.a_string != NULL)
+                         || ((dp->conversion == 'd' || dp->conversion == 'i')
+                             && (a.arg[dp->arg_index].type == TYPE_INT
+                                 || a.arg[dp->arg_index].type == TYPE_LONGINT))
+                         || (dp->conversion == 'u'
+                             && (a.arg[dp->arg_index].type == TYPE_UINT
+                                 || a.arg[dp->arg_index].type == TYPE_ULONGINT))))
+              {
+                /* A plain %s, %d, %i or %u directive, possibly with a size
+                   modifier and an argument position.  Format it here, since
+                   going through SNPRINTF is much slower.  */
+                if (dp->conversion == 's')
+                  {
+                    const char *arg = a.arg[dp->arg_index].a.a_string;
+                    size_t n = strlen (arg);
+
+                    ENSURE_ALLOCATION (xsum (length, n));
+                    memcpy (result + length, arg, n);
+                    length += n;
+                  }
+                else
+                  {
+                    /* Room for the digits of an unsigned long in base 10,
+                       and for the sign.  */
+                    char digits[3 * sizeof (unsigned long) + 1];
+                    char *p = digits + sizeof (digits);
+                    unsigned long value;
+                    int negative = 0;
+                    size_t n;
+
+                    switch (a.arg[dp->arg_index].type)
+                      {
+                      case TYPE_INT:
+                        {
+                          int arg = a.arg[dp->arg_index].a.a_int;
+                          negative = (arg < 0);
+                          value = (negative
+                                   ? - (unsigned long) arg
+                                   : (unsigned long) arg);
+                        }
+                        break;
+                      case TYPE_LONGINT:
+                        {
+                          long int arg = a.arg[dp->arg_index].a.a_longint;
+                          negative = (arg < 0);
+                          value = (negative
+                                   ? - (unsigned long) arg
+                                   : (unsigned long) arg);
+                        }
+                        break;
+                      case TYPE_UINT:
+                        value = a.arg[dp->arg_index].a.a_uint;
+                        break;
+                      default: /* TYPE_ULONGINT */
+                        value = a.arg[dp->arg_index].a.a_ulongint;
+                        break;
+                      }
+                    do
+                      {
+                        *--p = '0' + value % 10;
+                        value = value / 10;
+                      }
+                    while (value > 0);
+                    if (negative)
+                      *--p = '-';
+                    n = digits + sizeof (digits) - p;
+
+                    ENSURE_ALLOCATION (xsum (length, n));
+                    memcpy (result + length, p, n);
+                    length += n;
+                  }
+              }
 #endif
             else
               {
@@ -0,0 +1,72 @@
+/* Records of the batch mode of gettext and ngettext.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* Specification.  */
+#include "batch-record.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "error.h"
+#include "gettext.h"
+
+#define _(str) gettext (str)
+
+
+void
+write_record (const char *str, char delimiter)
+{
+  if (delimiter == '\n')
+    {
+      /* Escape newlines and backslashes, so that the record is one line.  */
+      for (; *str != '\0'; str++)
+        if (*str == '\n')
+          fputs ("\\n", stdout);
+        else
+          {
+            if (*str == '\\')
+              putc ('\\', stdout);
+            putc (*str, stdout);
+          }
+    }
+  else
+    fputs (str, stdout);
+  putc (delimiter, stdout);
+  fflush (stdout);
+}
+
+
+bool
+read_record (char **linep, size_t *sizep, char delimiter)
+{
+  ssize_t len = getdelim (linep, sizep, delimiter, stdin);
+
+  if (len <= 0)
+    {
+      if (ferror (stdin))
+        error (EXIT_FAILURE, errno, _("error while reading \"%s\""),
+               _("standard input"));
+      return false;
+    }
+  if ((*linep)[len - 1] == delimiter)
+    (*linep)[len - 1] = '\0';
+  return true;
+}
@@ -0,0 +1,44 @@
+/* Records of the batch mode of gettext and ngettext.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _BATCH_RECORD_H
+#define _BATCH_RECORD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Writes STR as a record of the batch mode output, terminated by
+   DELIMITER, and flushes it, since the reader usually waits for it.
+   When DELIMITER is a newline, newlines and backslashes in STR are
+   escaped.  */
+extern void write_record (const char *str, char delimiter);
+
+/* Reads a record of the batch mode input, terminated by DELIMITER, into
+   *LINEP.  Returns false at end of file.  */
+extern bool read_record (char **linep, size_t *sizep, char delimiter);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BATCH_RECORD_H */
@@ -1,5 +1,5 @@
 /* gettext - retrieve text string from message catalog and print it.
-   Copyright (C) 1995-1997, 2000-2007, 2012 Free Software Foundation, Inc.
+   Copyright (C) 1995-1997, 2000-2007, 2012, 2026 Free Software Foundation, Inc.
    Written by Ulrich Drepper <drepper@gnu.ai.mit.edu>, May 1995.
 
    This program is free software: you can redistribute it and/or modify
@@ -20,6 +20,7 @@
 #endif
 
 #include <getopt.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -33,6 +34,7 @@
 #include "basename.h"
 #include "xalloc.h"
 #include "propername.h"
+#include "batch-record.h"
 #include "gettext.h"
 
 #define _(str) gettext (str)
@@ -45,11 +47,16 @@ static bool add_newline;
    message catalog.  */
 static bool do_expand;
 
+/* The character that terminates each record in batch mode.  */
+static char record_delimiter;
+
 /* Long options.  */
 static const struct option long_options[] =
 {
+  { "batch", no_argument, NULL, CHAR_MAX + 1 },
   { "domain", required_argument, NULL, 'd' },
   { "help", no_argument, NULL, 'h' },
+  { "null", no_argument, NULL, '0' },
   { "shell-script", no_argument, NULL, 's' },
   { "version", no_argument, NULL, 'V' },
   { NULL, 0, NULL, 0 }
@@ -62,6 +69,7 @@ static void usage (int status)
 #endif
 ;
 static const char *expand_escape (const char *str);
+static void batch (const char *domain);
 
 int
 main (int argc, char *argv[])
@@ -70,6 +78,7 @@ main (int argc, char *argv[])
   const char *msgid;
 
   /* Default values for command line options.  */
+  bool do_batch = false;
   bool do_help = false;
   bool do_shell = false;
   bool do_version = false;
@@ -77,6 +86,7 @@ main (int argc, char *argv[])
   const char *domaindir = getenv ("TEXTDOMAINDIR");
   add_newline = true;
   do_expand = false;
+  record_delimiter = '\n';
 
   /* Set program name for message texts.  */
   set_program_name (argv[0]);
@@ -94,12 +104,15 @@ main (int argc, char *argv[])
   atexit (close_stdout);
 
   /* Parse command line options.  */
-  while ((optchar = getopt_long (argc, argv, "+d:eEhnsV", long_options, NULL))
+  while ((optchar = getopt_long (argc, argv, "+0d:eEhnsV", long_options, NULL))
          != EOF)
     switch (optchar)
     {
     case '\0':          /* Long option.  */
       break;
+    case '0':
+      record_delimiter = '\0';
+      break;
     case 'd':
       domain = optarg;
       break;
@@ -121,6 +134,9 @@ main (int argc, char *argv[])
     case 'V':
       do_version = true;
       break;
+    case CHAR_MAX + 1:  /* --batch */
+      do_batch = true;
+      break;
     default:
       usage (EXIT_FAILURE);
     }
@@ -144,6 +160,39 @@ There is NO WARRANTY, to the extent permitted by law.\n\
   if (do_help)
     usage (EXIT_SUCCESS);
 
+  /* In batch mode, the messages come from standard input.  */
+  if (do_batch)
+    {
+      if (do_shell)
+        error (EXIT_FAILURE, 0, _("%s and %s are mutually exclusive"),
+               "--batch", "-s");
+
+      /* Get arguments.  */
+      switch (argc - optind)
+        {
+          default:
+            error (EXIT_FAILURE, 0, _("too many arguments"));
+
+          case 1:
+            domain = argv[optind++];
+            /* FALLTHROUGH */
+
+          case 0:
+            break;
+        }
+
+      /* If no domain name is given we don't translate.  */
+      if (domain == NULL || domain[0] == '\0')
+        domain = NULL;
+      else
+        /* Bind domain to appropriate directory.  */
+        if (domaindir != NULL && domaindir[0] != '\0')
+          bindtextdomain (domain, domaindir);
+
+      batch (domain);
+      exit (EXIT_SUCCESS);
+    }
+
   /* We have two major modes: use following Uniforum spec and as
      internationalized 'echo' program.  */
   if (!do_shell)
@@ -243,7 +292,8 @@ usage (int status)
       printf (_("\
 Usage: %s [OPTION] [[TEXTDOMAIN] MSGID]\n\
 or:    %s [OPTION] -s [MSGID]...\n\
-"), program_name, program_name);
+or:    %s [OPTION] --batch [TEXTDOMAIN]\n\
+"), program_name, program_name, program_name);
       printf ("\n");
       /* xgettext: no-wrap */
       printf (_("\
@@ -257,6 +307,10 @@ Display native language translation of a textual message.\n"));
   -h, --help                display this help and exit\n\
   -n                        suppress trailing newline\n\
   -V, --version             display version information and exit\n\
+      --batch               read MSGIDs from standard input and write their\n\
+                            translations, until end of file\n\
+  -0, --null                in batch mode, terminate records with NUL\n\
+                            instead of newline\n\
   [TEXTDOMAIN] MSGID        retrieve translated message corresponding\n\
                             to MSGID from TEXTDOMAIN\n"));
       printf ("\n");
@@ -269,6 +323,9 @@ variable TEXTDOMAINDIR.\n\
 When used with the -s option the program behaves like the 'echo' command.\n\
 But it does not simply copy its arguments to stdout.  Instead those messages\n\
 found in the selected catalog are translated.\n\
+When used with the --batch option the program reads one MSGID per line, and\n\
+writes one translation per line, with newlines and backslashes written as\n\
+\\n and \\\\.  With the -0 option, records end with NUL and are not escaped.\n\
 Standard search directory: %s\n"),
               getenv ("IN_HELP2MAN") == NULL ? LOCALEDIR : "@localedir@");
       printf ("\n");
@@ -384,3 +441,30 @@ expand_escape (const char *str)
 
   return (const char *) retval;
 }
+
+
+/* Translates the records read from standard input, until end of file.
+   DOMAIN is NULL if the messages shall not be translated.  */
+static void
+batch (const char *domain)
+{
+  char *line = NULL;
+  size_t line_size = 0;
+
+  while (read_record (&line, &line_size, record_delimiter))
+    {
+      const char *msgid = line;
+
+      /* Expand escape sequences if enabled.  */
+      if (do_expand)
+        msgid = expand_escape (msgid);
+
+      /* Write out the result.  */
+      write_record (domain == NULL ? msgid : dgettext (domain, msgid),
+                    record_delimiter);
+
+      if (msgid != line)
+        free ((char *) msgid);
+    }
+  free (line);
+}
@@ -1,5 +1,5 @@
 /* ngettext - retrieve plural form string from message catalog and print it.
-   Copyright (C) 1995-1997, 2000-2007 Free Software Foundation, Inc.
+   Copyright (C) 1995-1997, 2000-2007, 2026 Free Software Foundation, Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -19,6 +19,7 @@
 #endif
 
 #include <getopt.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -33,6 +34,7 @@
 #include "basename.h"
 #include "xalloc.h"
 #include "propername.h"
+#include "batch-record.h"
 #include "gettext.h"
 
 #define _(str) gettext (str)
@@ -41,11 +43,16 @@
    message catalog.  */
 static int do_expand;
 
+/* The character that terminates each record in batch mode.  */
+static char record_delimiter;
+
 /* Long options.  */
 static const struct option long_options[] =
 {
+  { "batch", no_argument, NULL, CHAR_MAX + 1 },
   { "domain", required_argument, NULL, 'd' },
   { "help", no_argument, NULL, 'h' },
+  { "null", no_argument, NULL, '0' },
   { "version", no_argument, NULL, 'V' },
   { NULL, 0, NULL, 0 }
 };
@@ -57,6 +64,8 @@ static void usage (int status)
 #endif
 ;
 static const char *expand_escape (const char *str);
+static unsigned long get_count (const char *count);
+static void batch (const char *domain);
 
 int
 main (int argc, char *argv[])
@@ -68,11 +77,13 @@ main (int argc, char *argv[])
   unsigned long n;
 
   /* Default values for command line options.  */
+  bool do_batch = false;
   bool do_help = false;
   bool do_version = false;
   const char *domain = getenv ("TEXTDOMAIN");
   const char *domaindir = getenv ("TEXTDOMAINDIR");
   do_expand = false;
+  record_delimiter = '\n';
 
   /* Set program name for message texts.  */
   set_program_name (argv[0]);
@@ -90,12 +101,15 @@ main (int argc, char *argv[])
   atexit (close_stdout);
 
   /* Parse command line options.  */
-  while ((optchar = getopt_long (argc, argv, "+d:eEhV", long_options, NULL))
+  while ((optchar = getopt_long (argc, argv, "+0d:eEhV", long_options, NULL))
          != EOF)
     switch (optchar)
     {
     case '\0':          /* Long option.  */
       break;
+    case '0':
+      record_delimiter = '\0';
+      break;
     case 'd':
       domain = optarg;
       break;
@@ -111,6 +125,9 @@ main (int argc, char *argv[])
     case 'V':
       do_version = true;
       break;
+    case CHAR_MAX + 1:  /* --batch */
+      do_batch = true;
+      break;
     default:
       usage (EXIT_FAILURE);
     }
@@ -134,6 +151,34 @@ There is NO WARRANTY, to the extent permitted by law.\n\
   if (do_help)
     usage (EXIT_SUCCESS);
 
+  /* In batch mode, the messages and counts come from standard input.  */
+  if (do_batch)
+    {
+      switch (argc - optind)
+        {
+        default:
+          error (EXIT_FAILURE, 0, _("too many arguments"));
+
+        case 1:
+          domain = argv[optind++];
+          /* FALLTHROUGH */
+
+        case 0:
+          break;
+        }
+
+      /* If no domain name is given we don't translate.  */
+      if (domain == NULL || domain[0] == '\0')
+        domain = NULL;
+      else
+        /* Bind domain to appropriate directory.  */
+        if (domaindir != NULL && domaindir[0] != '\0')
+          bindtextdomain (domain, domaindir);
+
+      batch (domain);
+      exit (EXIT_SUCCESS);
+    }
+
   /* More optional command line options.  */
   switch (argc - optind)
     {
@@ -161,18 +206,7 @@ There is NO WARRANTY, to the extent permitted by law.\n\
   if (optind != argc)
     abort ();
 
-  {
-    char *endp;
-    unsigned long tmp_val;
-
-    errno = 0;
-    tmp_val = strtoul (count, &endp, 10);
-    if (errno == 0 && count[0] != '\0' && endp[0] == '\0')
-      n = tmp_val;
-    else
-      /* When COUNT is not valid, use plural.  */
-      n = 99;
-  }
+  n = get_count (count);
 
   /* Expand escape sequences if enabled.  */
   if (do_expand)
@@ -211,7 +245,8 @@ usage (int status)
       /* xgettext: no-wrap */
       printf (_("\
 Usage: %s [OPTION] [TEXTDOMAIN] MSGID MSGID-PLURAL COUNT\n\
-"), program_name);
+or:    %s [OPTION] --batch [TEXTDOMAIN]\n\
+"), program_name, program_name);
       printf ("\n");
       /* xgettext: no-wrap */
       printf (_("\
@@ -225,6 +260,11 @@ form depends on a number.\n"));
   -E                        (ignored for compatibility)\n\
   -h, --help                display this help and exit\n\
   -V, --version             display version information and exit\n\
+      --batch               read MSGID, MSGID-PLURAL, COUNT triples from\n\
+                            standard input and write their translations,\n\
+                            until end of file\n\
+  -0, --null                in batch mode, terminate records with NUL\n\
+                            instead of newline\n\
   [TEXTDOMAIN]              retrieve translated message from TEXTDOMAIN\n\
   MSGID MSGID-PLURAL        translate MSGID (singular) / MSGID-PLURAL (plural)\n\
   COUNT                     choose singular/plural form based on this value\n"));
@@ -235,6 +275,10 @@ If the TEXTDOMAIN parameter is not given, the domain is determined from the\n\
 environment variable TEXTDOMAIN.  If the message catalog is not found in the\n\
 regular directory, another location can be specified with the environment\n\
 variable TEXTDOMAINDIR.\n\
+When used with the --batch option the program reads MSGID, MSGID-PLURAL and\n\
+COUNT on one line each, and writes one translation per line, with newlines\n\
+and backslashes written as \\n and \\\\.  With the -0 option, records end\n\
+with NUL and are not escaped.\n\
 Standard search directory: %s\n"),
               getenv ("IN_HELP2MAN") == NULL ? LOCALEDIR : "@localedir@");
       printf ("\n");
@@ -346,3 +390,68 @@ expand_escape (const char *str)
 
   return (const char *) retval;
 }
+
+
+/* Converts the COUNT argument to a number.  */
+static unsigned long
+get_count (const char *count)
+{
+  char *endp;
+  unsigned long tmp_val;
+
+  errno = 0;
+  tmp_val = strtoul (count, &endp, 10);
+  if (errno == 0 && count[0] != '\0' && endp[0] == '\0')
+    return tmp_val;
+  else
+    /* When COUNT is not valid, use plural.  */
+    return 99;
+}
+
+
+/* Translates the MSGID, MSGID-PLURAL, COUNT triples read from standard
+   input, until end of file.  DOMAIN is NULL if the messages shall not be
+   translated.  */
+static void
+batch (const char *domain)
+{
+  char *lines[3] = { NULL, NULL, NULL };
+  size_t sizes[3] = { 0, 0, 0 };
+
+  while (read_record (&lines[0], &sizes[0], record_delimiter))
+    {
+      const char *msgid;
+      const char *msgid_plural;
+      unsigned long n;
+
+      if (!read_record (&lines[1], &sizes[1], record_delimiter)
+          || !read_record (&lines[2], &sizes[2], record_delimiter))
+        error (EXIT_FAILURE, 0, _("missing arguments"));
+
+      msgid = lines[0];
+      msgid_plural = lines[1];
+      n = get_count (lines[2]);
+
+      /* Expand escape sequences if enabled.  */
+      if (do_expand)
+        {
+          msgid = expand_escape (msgid);
+          msgid_plural = expand_escape (msgid_plural);
+        }
+
+      /* Write out the result.  */
+      if (domain == NULL)
+        write_record (n == 1 ? msgid : msgid_plural, record_delimiter);
+      else
+        write_record (dngettext (domain, msgid, msgid_plural, n),
+                      record_delimiter);
+
+      if (msgid != lines[0])
+        free ((char *) msgid);
+      if (msgid_plural != lines[1])
+        free ((char *) msgid_plural);
+    }
+  free (lines[0]);
+  free (lines[1]);
+  free (lines[2]);
+}
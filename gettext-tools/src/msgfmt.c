@@ -40,6 +40,9 @@
 #include "xalloc.h"
 #include "msgfmt.h"
 #include "write-mo.h"
+#include "write-bundle.h"
+#include "write-alias.h"
+#include "gmo.h"
 #include "write-java.h"
 #include "write-csharp.h"
 #include "write-resources.h"
@@ -94,6 +97,12 @@ static const char *tcl_base_directory;
 /* Qt mode output file specification.  */
 static bool qt_mode;
 
+/* Bundle mode: the input files are .mo files.  */
+static bool bundle_mode;
+
+/* Alias index mode: the input file is a locale.alias file.  */
+static bool alias_index_mode;
+
 /* We may have more than one input file.  Domains with same names in
    different files have to merged.  So we need a list of tables for
    each output file.  */
@@ -148,7 +157,9 @@ static int do_statistics;
 /* Long options.  */
 static const struct option long_options[] =
 {
+  { "alias-index", no_argument, NULL, CHAR_MAX + 15 },
   { "alignment", required_argument, NULL, 'a' },
+  { "bundle", no_argument, NULL, CHAR_MAX + 14 },
   { "check", no_argument, NULL, 'c' },
   { "check-accelerators", optional_argument, NULL, CHAR_MAX + 1 },
   { "check-compatibility", no_argument, NULL, 'C' },
@@ -353,6 +364,12 @@ main (int argc, char *argv[])
           byteswap = endianness ^ ENDIANNESS;
         }
         break;
+      case CHAR_MAX + 14: /* --bundle */
+        bundle_mode = true;
+        break;
+      case CHAR_MAX + 15: /* --alias-index */
+        alias_index_mode = true;
+        break;
       default:
         usage (EXIT_FAILURE);
         break;
@@ -391,9 +408,12 @@ There is NO WARRANTY, to the extent permitted by law.\n\
       | (csharp_mode ? 2 : 0)
       | (csharp_resources_mode ? 4 : 0)
       | (tcl_mode ? 8 : 0)
-      | (qt_mode ? 16 : 0);
+      | (qt_mode ? 16 : 0)
+      | (bundle_mode ? 32 : 0)
+      | (alias_index_mode ? 64 : 0);
     static const char *mode_options[] =
-      { "--java", "--csharp", "--csharp-resources", "--tcl", "--qt" };
+      { "--java", "--csharp", "--csharp-resources", "--tcl", "--qt",
+        "--bundle", "--alias-index" };
     /* More than one bit set?  */
     if (modes & (modes - 1))
       {
@@ -493,6 +513,26 @@ There is NO WARRANTY, to the extent permitted by law.\n\
         }
     }
 
+  /* In bundle mode, the input files are .mo files that are merely copied
+     into the bundle.  */
+  if (bundle_mode)
+    exit (msgdomain_write_bundle (argv + optind, argc - optind,
+                                  output_file_name != NULL
+                                  ? output_file_name : BUNDLE_FILENAME));
+
+  /* In alias index mode, the input file is a locale.alias file.  */
+  if (alias_index_mode)
+    {
+      if (argc - optind > 1)
+        {
+          error (EXIT_SUCCESS, 0, _("exactly one input file required"));
+          usage (EXIT_FAILURE);
+        }
+      exit (write_alias_index (argv[optind],
+                               output_file_name != NULL
+                               ? output_file_name : ALIAS_INDEX_FILENAME));
+    }
+
   /* The -o option determines the name of the domain and therefore
      the output file.  */
   if (output_file_name != NULL)
@@ -688,6 +728,12 @@ Operation mode:\n"));
       --tcl                   Tcl mode: generate a tcl/msgcat .msg file\n"));
       printf (_("\
       --qt                    Qt mode: generate a Qt .qm file\n"));
+      printf (_("\
+      --bundle                bundle mode: put the given .mo files into a\n\
+                                single file that libintl loads at once\n"));
+      printf (_("\
+      --alias-index           alias index mode: compile a locale.alias file\n\
+                                into an index that libintl reads faster\n"));
       printf ("\n");
       printf (_("\
 Output file location:\n"));
@@ -735,6 +781,27 @@ The -l and -d options are mandatory.  The .msg file is written in the\n\
 specified directory.\n"));
       printf ("\n");
       printf (_("\
+Input and output file location in bundle mode:\n"));
+      printf (_("\
+  filename.mo ...             input files, named LOCALE/CATEGORY/DOMAIN.mo\n\
+                                relative to the locale directory\n"));
+      printf (_("\
+  -o, --output-file=FILE      write output to specified file (default:\n\
+                                %s)\n"), BUNDLE_FILENAME);
+      printf (_("\
+The bundle is to be installed in the locale directory.\n"));
+      printf ("\n");
+      printf (_("\
+Input and output file location in alias index mode:\n"));
+      printf (_("\
+  locale.alias                input file\n"));
+      printf (_("\
+  -o, --output-file=FILE      write output to specified file (default:\n\
+                                %s)\n"), ALIAS_INDEX_FILENAME);
+      printf (_("\
+The index is to be installed next to the locale.alias file.\n"));
+      printf ("\n");
+      printf (_("\
 Input file syntax:\n"));
       printf (_("\
   -P, --properties-input      input files are in Java .properties syntax\n"));
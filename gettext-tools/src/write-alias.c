@@ -0,0 +1,271 @@
+/* Writing locale alias indexes.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* Specification.  */
+#include "write-alias.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* This include file describes the binary .mo format and the alias
+   indexes.  */
+#include "gmo.h"
+
+#include "byteswap.h"
+#include "c-ctype.h"
+#include "error.h"
+#include "write-mo.h"
+#include "xalloc.h"
+#include "binary-io.h"
+#include "fwriteerror.h"
+#include "gettext.h"
+
+#define _(str) gettext (str)
+
+
+/* An alias read from a locale.alias file.  */
+struct alias_item
+{
+  char *alias;
+  char *value;
+  /* Position in the file, to keep the first of several equal aliases.  */
+  size_t index;
+  /* Offsets in the alias index.  */
+  nls_uint32 alias_offset;
+  nls_uint32 value_offset;
+};
+
+
+/* Compare S1 and S2 like strcasecmp in the "C" locale.  libintl looks up
+   the aliases in this order.  */
+static int
+ascii_casecmp (const char *s1, const char *s2)
+{
+  for (;; s1++, s2++)
+    {
+      unsigned char c1 = c_tolower ((unsigned char) *s1);
+      unsigned char c2 = c_tolower ((unsigned char) *s2);
+
+      if (c1 != c2 || c1 == '\0')
+        return (int) c1 - (int) c2;
+    }
+}
+
+
+static int
+compare_items (const void *p1, const void *p2)
+{
+  const struct alias_item *item1 = (const struct alias_item *) p1;
+  const struct alias_item *item2 = (const struct alias_item *) p2;
+  int cmp = ascii_casecmp (item1->alias, item2->alias);
+
+  if (cmp != 0)
+    return cmp;
+  return (item1->index > item2->index) - (item1->index < item2->index);
+}
+
+
+/* Read the aliases of the locale.alias file FP, with the same syntax as
+   libintl: one alias per line, followed by its value, and comment lines
+   starting with '#'.  Store them in *ITEMSP and return their number.  */
+static size_t
+read_aliases (FILE *fp, struct alias_item **itemsp)
+{
+  struct alias_item *items = NULL;
+  size_t nitems = 0;
+  size_t nitems_max = 0;
+  size_t line_size = 100;
+  char *line = XNMALLOC (line_size, char);
+  size_t line_len;
+  int c;
+
+  do
+    {
+      char *cp;
+      char *alias;
+      char *value;
+
+      /* Read a line.  */
+      line_len = 0;
+      while ((c = getc (fp)) != EOF && c != '\n')
+        {
+          if (line_len + 1 >= line_size)
+            {
+              line_size = 2 * line_size;
+              line = (char *) xrealloc (line, line_size);
+            }
+          line[line_len++] = c;
+        }
+      if (c == EOF && line_len == 0)
+        break;
+      line[line_len] = '\0';
+
+      cp = line;
+      while (c_isspace (*cp))
+        cp++;
+      if (*cp == '\0' || *cp == '#')
+        continue;
+
+      alias = cp;
+      while (*cp != '\0' && !c_isspace (*cp))
+        cp++;
+      if (*cp != '\0')
+        *cp++ = '\0';
+      while (c_isspace (*cp))
+        cp++;
+      if (*cp == '\0')
+        /* An alias without a value is ignored.  */
+        continue;
+      value = cp;
+      while (*cp != '\0' && !c_isspace (*cp))
+        cp++;
+      *cp = '\0';
+
+      if (nitems == nitems_max)
+        {
+          nitems_max = 2 * nitems_max + 100;
+          items = (struct alias_item *)
+            xrealloc (items, nitems_max * sizeof (struct alias_item));
+        }
+      items[nitems].alias = xstrdup (alias);
+      items[nitems].value = xstrdup (value);
+      items[nitems].index = nitems;
+      nitems++;
+    }
+  while (c != EOF);
+
+  free (line);
+  *itemsp = items;
+  return nitems;
+}
+
+
+/* Write the 32-bit number VALUE to OUTPUT_FILE, honouring --endianness.  */
+static void
+write_uint32 (FILE *output_file, nls_uint32 value)
+{
+  if (byteswap)
+    value = bswap_32 (value);
+  fwrite (&value, sizeof (value), 1, output_file);
+}
+
+
+int
+write_alias_index (const char *input_file_name, const char *file_name)
+{
+  FILE *input_file;
+  struct alias_item *items;
+  size_t nitems;
+  struct alias_index_header header;
+  size_t offset;
+  size_t i;
+  size_t j;
+  FILE *output_file;
+
+  /* Read and sort the aliases.  */
+  if (strcmp (input_file_name, "-") == 0)
+    input_file = stdin;
+  else
+    {
+      input_file = fopen (input_file_name, "r");
+      if (input_file == NULL)
+        error (EXIT_FAILURE, errno,
+               _("error while opening \"%s\" for reading"), input_file_name);
+    }
+  nitems = read_aliases (input_file, &items);
+  if (ferror (input_file))
+    error (EXIT_FAILURE, errno, _("error while reading \"%s\""),
+           input_file_name);
+  if (input_file != stdin)
+    fclose (input_file);
+  qsort (items, nitems, sizeof (struct alias_item), compare_items);
+
+  /* Of several equal aliases, keep the first one.  */
+  for (i = j = 0; i < nitems; i++)
+    if (j > 0 && ascii_casecmp (items[j - 1].alias, items[i].alias) == 0)
+      {
+        free (items[i].alias);
+        free (items[i].value);
+      }
+    else
+      items[j++] = items[i];
+  nitems = j;
+
+  /* Lay out the alias index: the header, the table of entries, and the
+     strings.  The file ends with a NUL byte.  */
+  header.magic = _MAGIC_ALIAS;
+  header.revision = ALIAS_REVISION_NUMBER;
+  header.nentries = nitems;
+  header.entries_offset = sizeof (struct alias_index_header);
+  offset = header.entries_offset + nitems * sizeof (struct alias_index_entry);
+  for (i = 0; i < nitems; i++)
+    {
+      items[i].alias_offset = offset;
+      offset += strlen (items[i].alias) + 1;
+      items[i].value_offset = offset;
+      offset += strlen (items[i].value) + 1;
+      if (offset > (nls_uint32) ~(nls_uint32) 0)
+        error (EXIT_FAILURE, 0, _("the alias index would be too large"));
+    }
+
+  if (strcmp (file_name, "-") == 0)
+    {
+      output_file = stdout;
+      SET_BINARY (fileno (output_file));
+    }
+  else
+    {
+      output_file = fopen (file_name, "wb");
+      if (output_file == NULL)
+        {
+          error (0, errno, _("error while opening \"%s\" for writing"),
+                 file_name);
+          return 1;
+        }
+    }
+
+  write_uint32 (output_file, header.magic);
+  write_uint32 (output_file, header.revision);
+  write_uint32 (output_file, header.nentries);
+  write_uint32 (output_file, header.entries_offset);
+  for (i = 0; i < nitems; i++)
+    {
+      write_uint32 (output_file, items[i].alias_offset);
+      write_uint32 (output_file, items[i].value_offset);
+    }
+  for (i = 0; i < nitems; i++)
+    {
+      fwrite (items[i].alias, 1, strlen (items[i].alias) + 1, output_file);
+      fwrite (items[i].value, 1, strlen (items[i].value) + 1, output_file);
+      free (items[i].alias);
+      free (items[i].value);
+    }
+  free (items);
+
+  /* Make sure nothing went wrong.  */
+  if (fwriteerror (output_file))
+    error (EXIT_FAILURE, errno, _("error while writing \"%s\" file"),
+           file_name);
+
+  return 0;
+}
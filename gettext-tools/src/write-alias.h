@@ -0,0 +1,28 @@
+/* Writing locale alias indexes.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifndef _WRITE_ALIAS_H
+#define _WRITE_ALIAS_H
+
+/* Compile the locale.alias file INPUT_FILE_NAME into an alias index, which
+   libintl reads instead of it.  input_file_name may be "-" for standard
+   input.  file_name is the desired file name, or "-" for standard output.
+   Return 0 if ok, nonzero on error.  */
+extern int
+       write_alias_index (const char *input_file_name, const char *file_name);
+
+#endif /* _WRITE_ALIAS_H */
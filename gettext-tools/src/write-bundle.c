@@ -0,0 +1,268 @@
+/* Writing bundles of binary .mo files.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* Specification.  */
+#include "write-bundle.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* This include file describes the binary .mo format and the bundles.  */
+#include "gmo.h"
+
+#include "byteswap.h"
+#include "concat-filename.h"
+#include "dir-list.h"
+#include "error.h"
+#include "write-mo.h"
+#include "xalloc.h"
+#include "binary-io.h"
+#include "fwriteerror.h"
+#include "gettext.h"
+
+#define _(str) gettext (str)
+
+
+/* A .mo file to be put into a bundle.  */
+struct bundle_item
+{
+  /* Name relative to the locale directory.  */
+  const char *name;
+  /* Contents.  */
+  char *data;
+  size_t length;
+  /* Offset in the bundle.  */
+  nls_uint32 name_offset;
+  nls_uint32 data_offset;
+};
+
+
+/* Read the .mo file NAME, searching it in the directories given with -D,
+   into ITEM.  */
+static void
+read_item (const char *name, struct bundle_item *item)
+{
+  FILE *fp = NULL;
+  char *file_name = NULL;
+  const char *dir;
+  size_t alloc;
+  nls_uint32 magic = 0;
+  int j;
+
+  for (j = 0; (dir = dir_list_nth (j)) != NULL; ++j)
+    {
+      file_name = xconcatenated_filename (dir, name, NULL);
+      fp = fopen (file_name, "rb");
+      if (fp != NULL || errno != ENOENT)
+        break;
+      free (file_name);
+      file_name = NULL;
+    }
+  if (fp == NULL)
+    error (EXIT_FAILURE, errno, _("error while opening \"%s\" for reading"),
+           file_name != NULL ? file_name : name);
+
+  item->name = name;
+  item->length = 0;
+  alloc = 4096;
+  item->data = XNMALLOC (alloc, char);
+  for (;;)
+    {
+      size_t n = fread (item->data + item->length, 1, alloc - item->length,
+                        fp);
+
+      item->length += n;
+      if (item->length < alloc)
+        break;
+      alloc = 2 * alloc;
+      item->data = (char *) xrealloc (item->data, alloc);
+    }
+  if (ferror (fp))
+    error (EXIT_FAILURE, errno, _("error while reading \"%s\""), file_name);
+  fclose (fp);
+
+  if (item->length >= sizeof (nls_uint32))
+    memcpy (&magic, item->data, sizeof (nls_uint32));
+  if (item->length < sizeof (nls_uint32)
+      || (magic != _MAGIC && magic != _MAGIC_SWAPPED))
+    error (EXIT_FAILURE, 0, _("file \"%s\" is not in GNU .mo format"),
+           file_name);
+  if (item->length > (nls_uint32) ~(nls_uint32) 0)
+    error (EXIT_FAILURE, 0, _("file \"%s\" is too large"), file_name);
+
+  free (file_name);
+}
+
+
+/* Check that NAME has the form LOCALE/CATEGORY/DOMAIN.mo, which is how
+   libintl looks it up.  */
+static bool
+is_bundle_name (const char *name)
+{
+  const char *p;
+  int slashes = 0;
+  size_t len = strlen (name);
+
+  if (len < 3 || memcmp (name + len - 3, ".mo", 3) != 0 || name[0] == '/')
+    return false;
+  for (p = name; *p != '\0'; p++)
+    if (*p == '/')
+      {
+        /* No empty components, and no "." or ".." components.  */
+        if (p[1] == '/' || p[1] == '\0'
+            || (p[1] == '.' && (p[2] == '/' || (p[2] == '.' && p[3] == '/'))))
+          return false;
+        slashes++;
+      }
+  return slashes == 2
+         && !(name[0] == '.' && (name[1] == '/' || name[1] == '.'));
+}
+
+
+static int
+compare_items (const void *p1, const void *p2)
+{
+  const struct bundle_item *item1 = (const struct bundle_item *) p1;
+  const struct bundle_item *item2 = (const struct bundle_item *) p2;
+
+  return strcmp (item1->name, item2->name);
+}
+
+
+/* Write the 32-bit number VALUE to OUTPUT_FILE, honouring --endianness.  */
+static void
+write_uint32 (FILE *output_file, nls_uint32 value)
+{
+  if (byteswap)
+    value = bswap_32 (value);
+  fwrite (&value, sizeof (value), 1, output_file);
+}
+
+
+/* Write NBYTES zero bytes to OUTPUT_FILE.  */
+static void
+write_padding (FILE *output_file, size_t nbytes)
+{
+  static const char zeroes[8];
+
+  fwrite (zeroes, 1, nbytes, output_file);
+}
+
+
+int
+msgdomain_write_bundle (char **names, size_t nnames, const char *file_name)
+{
+  struct bundle_item *items;
+  struct bundle_header header;
+  size_t offset;
+  size_t i;
+  FILE *output_file;
+
+  /* Read and sort the .mo files.  */
+  items = XNMALLOC (nnames, struct bundle_item);
+  for (i = 0; i < nnames; i++)
+    {
+      if (!is_bundle_name (names[i]))
+        error (EXIT_FAILURE, 0,
+               _("\"%s\" is not of the form LOCALE/CATEGORY/DOMAIN.mo"),
+               names[i]);
+      read_item (names[i], &items[i]);
+    }
+  qsort (items, nnames, sizeof (struct bundle_item), compare_items);
+  for (i = 1; i < nnames; i++)
+    if (strcmp (items[i - 1].name, items[i].name) == 0)
+      error (EXIT_FAILURE, 0, _("duplicate input file \"%s\""),
+             items[i].name);
+
+  /* Lay out the bundle: the header, the table of entries, the names, and
+     the .mo files, each aligned to 8 bytes.  */
+  header.magic = _MAGIC_BUNDLE;
+  header.revision = BUNDLE_REVISION_NUMBER;
+  header.nentries = nnames;
+  header.entries_offset = sizeof (struct bundle_header);
+  offset = header.entries_offset + nnames * sizeof (struct bundle_entry);
+  for (i = 0; i < nnames; i++)
+    {
+      items[i].name_offset = offset;
+      offset += strlen (items[i].name) + 1;
+    }
+  for (i = 0; i < nnames; i++)
+    {
+      offset = (offset + 7) & ~(size_t) 7;
+      items[i].data_offset = offset;
+      offset += items[i].length;
+      if (offset > (nls_uint32) ~(nls_uint32) 0)
+        error (EXIT_FAILURE, 0, _("the bundle would be too large"));
+    }
+
+  if (strcmp (file_name, "-") == 0)
+    {
+      output_file = stdout;
+      SET_BINARY (fileno (output_file));
+    }
+  else
+    {
+      output_file = fopen (file_name, "wb");
+      if (output_file == NULL)
+        {
+          error (0, errno, _("error while opening \"%s\" for writing"),
+                 file_name);
+          return 1;
+        }
+    }
+
+  write_uint32 (output_file, header.magic);
+  write_uint32 (output_file, header.revision);
+  write_uint32 (output_file, header.nentries);
+  write_uint32 (output_file, header.entries_offset);
+  for (i = 0; i < nnames; i++)
+    {
+      write_uint32 (output_file, strlen (items[i].name));
+      write_uint32 (output_file, items[i].name_offset);
+      write_uint32 (output_file, items[i].length);
+      write_uint32 (output_file, items[i].data_offset);
+    }
+  offset = header.entries_offset + nnames * sizeof (struct bundle_entry);
+  for (i = 0; i < nnames; i++)
+    {
+      size_t len = strlen (items[i].name) + 1;
+
+      fwrite (items[i].name, 1, len, output_file);
+      offset += len;
+    }
+  for (i = 0; i < nnames; i++)
+    {
+      write_padding (output_file, items[i].data_offset - offset);
+      fwrite (items[i].data, 1, items[i].length, output_file);
+      offset = items[i].data_offset + items[i].length;
+      free (items[i].data);
+    }
+  free (items);
+
+  /* Make sure nothing went wrong.  */
+  if (fwriteerror (output_file))
+    error (EXIT_FAILURE, errno, _("error while writing \"%s\" file"),
+           file_name);
+
+  return 0;
+}
@@ -0,0 +1,31 @@
+/* Writing bundles of binary .mo files.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _WRITE_BUNDLE_H
+#define _WRITE_BUNDLE_H
+
+#include <stddef.h>
+
+/* Write a bundle of the .mo files NAMES[0..NNAMES-1].  Each name is of the
+   form LOCALE/CATEGORY/DOMAIN.mo, relative to a locale directory, and the
+   file is searched in the directories given with -D.  file_name is the
+   desired file name, or "-" for standard output.
+   Return 0 if ok, nonzero on error.  */
+extern int
+       msgdomain_write_bundle (char **names, size_t nnames,
+                               const char *file_name);
+
+#endif /* _WRITE_BUNDLE_H */
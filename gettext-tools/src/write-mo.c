@@ -156,6 +156,7 @@ write_table (FILE *output_file, message_list_ty *mlp)
   int minor_revision;
   bool omit_hash_table;
   nls_uint32 hash_tab_size;
+  nls_uint32 hash2_tab_size;
   struct mo_file_header header; /* Header of the .mo file to be written.  */
   size_t header_size;
   size_t offset;
@@ -373,10 +374,14 @@ write_table (FILE *output_file, message_list_ty *mlp)
   major_revision =
     (have_outdigits ? MO_REVISION_NUMBER_WITH_SYSDEP_I : MO_REVISION_NUMBER);
 
-  /* We need minor revision 1 if there are system dependent strings.
-     Otherwise we choose minor revision 0 because it's supported by older
-     versions of libintl and revision 1 isn't.  */
-  minor_revision = (n_sysdep_strings > 0 ? 1 : 0);
+  /* We use minor revision 2 when writing hash tables, because it adds a
+     secondary hash table that is faster to look up.  Older versions of
+     libintl read such files like minor revision 1 files, through the
+     primary hash table.  Otherwise we need minor revision 1 if there are
+     system dependent strings, and choose minor revision 0 when there are
+     none because it's supported by older versions of libintl and
+     revision 1 isn't.  */
+  minor_revision = (!no_hash_table ? 2 : n_sysdep_strings > 0 ? 1 : 0);
 
   /* In minor revision >= 1, the hash table is obligatory.  */
   omit_hash_table = (no_hash_table && minor_revision == 0);
@@ -411,6 +416,24 @@ write_table (FILE *output_file, message_list_ty *mlp)
   else
     hash_tab_size = 0;
 
+  /* The secondary hash table, present in minor revision >= 2, is keyed by
+     hash_string_murmur3 instead, which hashes a word at a time and spreads
+     long strings with common prefixes much better than hashpjw.  Its size
+     M2 is the smallest power of 2 bigger than 4 / 3 * N, so that the
+     initial index is V % M2 = V & (M2 - 1), and collisions are resolved by
+     linear probing, which stays within few cache lines at this load.
+     Each entry is followed by V itself, as a fingerprint: a lookup can
+     then skip the entries of other strings without reading their string
+     descriptor and string, which would be two more cache misses each.  */
+  if (minor_revision >= 2)
+    {
+      hash2_tab_size = 4;
+      while (hash2_tab_size < (mlp->nitems * 4) / 3 + 1)
+        hash2_tab_size <<= 1;
+    }
+  else
+    hash2_tab_size = 0;
+
 
   /* Second pass: Fill the structure describing the header.  At the same time,
      compute the sizes and offsets of the non-string parts of the file.  */
@@ -423,6 +446,8 @@ write_table (FILE *output_file, message_list_ty *mlp)
   header_size =
     (minor_revision == 0
      ? offsetof (struct mo_file_header, n_sysdep_segments)
+     : minor_revision == 1
+     ? offsetof (struct mo_file_header, hash2_function)
      : sizeof (struct mo_file_header));
   offset = header_size;
 
@@ -445,6 +470,17 @@ write_table (FILE *output_file, message_list_ty *mlp)
   header.hash_tab_offset = offset;
   offset += hash_tab_size * sizeof (nls_uint32);
 
+  if (minor_revision >= 2)
+    {
+      /* Hash function of secondary hash table.  */
+      header.hash2_function = MO_HASH_FUNCTION_MURMUR3_WITH_FINGERPRINTS;
+      /* Size of secondary hash table.  */
+      header.hash2_tab_size = hash2_tab_size;
+      /* Offset of secondary hash table.  */
+      header.hash2_tab_offset = offset;
+      offset += 2 * hash2_tab_size * sizeof (nls_uint32);
+    }
+
   if (minor_revision >= 1)
     {
       /* Size of table describing system dependent segments.  */
@@ -497,6 +533,12 @@ write_table (FILE *output_file, message_list_ty *mlp)
           BSWAP32 (header.orig_sysdep_tab_offset);
           BSWAP32 (header.trans_sysdep_tab_offset);
         }
+      if (minor_revision >= 2)
+        {
+          BSWAP32 (header.hash2_function);
+          BSWAP32 (header.hash2_tab_size);
+          BSWAP32 (header.hash2_tab_offset);
+        }
     }
   fwrite (&header, header_size, 1, output_file);
 
@@ -585,6 +627,41 @@ write_table (FILE *output_file, message_list_ty *mlp)
       free (hash_tab);
     }
 
+  if (minor_revision >= 2)
+    {
+      nls_uint32 *hash2_tab;
+      nls_uint32 mask = hash2_tab_size - 1;
+      unsigned int j;
+
+      /* Here output_file is at position header.hash2_tab_offset.  */
+
+      hash2_tab = XNMALLOC (2 * hash2_tab_size, nls_uint32);
+      memset (hash2_tab, '\0', 2 * hash2_tab_size * sizeof (nls_uint32));
+
+      /* Insert all values, following the algorithm described above.  */
+      for (j = 0; j < nstrings; j++)
+        {
+          const char *msgid = msg_arr[j].str[M_ID].pointer;
+          nls_uint32 hash_val = hash_string_murmur3 (msgid, strlen (msgid));
+          nls_uint32 idx = hash_val & mask;
+
+          while (hash2_tab[2 * idx] != 0)
+            idx = (idx + 1) & mask;
+
+          hash2_tab[2 * idx] = j + 1;
+          hash2_tab[2 * idx + 1] = hash_val;
+        }
+
+      /* Write the secondary hash table out.  */
+      if (byteswap)
+        for (j = 0; j < 2 * hash2_tab_size; j++)
+          BSWAP32 (hash2_tab[j]);
+      fwrite (hash2_tab, 2 * hash2_tab_size * sizeof (nls_uint32), 1,
+              output_file);
+
+      free (hash2_tab);
+    }
+
   if (minor_revision >= 1)
     {
       struct sysdep_segment *sysdep_segments_tab;
@@ -0,0 +1,37 @@
+/* Checks of the results of libintl calls, for the test programs.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _CHECK_PRG_H
+#define _CHECK_PRG_H
+
+#include <stdio.h>
+#include <string.h>
+
+/* The exit code of the test program: 1 if a check failed, 0 otherwise.  */
+static int result;
+
+/* Check that the call numbered CALL returned the string EXPECTED.  */
+static void
+check (int call, const char *s, const char *expected)
+{
+  if (strcmp (s, expected) != 0)
+    {
+      fprintf (stderr, "call %d returned: %s\n", call, s);
+      result = 1;
+    }
+}
+
+#endif /* _CHECK_PRG_H */
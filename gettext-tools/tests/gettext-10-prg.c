@@ -0,0 +1,117 @@
+/* Test program, used by the gettext-10 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+static const char *messages[][2] =
+{
+  { "one", "un" },
+  { "two", "deux" },
+  { "three", "trois" },
+  { "four", "quatre" },
+  { "five", "cinq" },
+  { "six", "six" },
+  { "seven", "sept" },
+  { "eight", "huit" },
+  { "nine", "neuf" },
+  { "ten", "dix" },
+  { "eleven", "onze" },
+  { "twelve", "douze" }
+};
+
+int
+main (int argc, char *argv[])
+{
+  struct libintl_cache_stats stats;
+  int result = 0;
+  int round;
+  size_t i;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  textdomain ("tstcache");
+  bindtextdomain ("tstcache", ".");
+
+  libintl_set_cache_capacity (4);
+  libintl_count_cache_hits (1);
+
+  /* Look up more messages than fit in the cache.  */
+  for (round = 0; round < 2; round++)
+    for (i = 0; i < sizeof (messages) / sizeof (messages[0]); i++)
+      {
+	const char *s = gettext (messages[i][0]);
+
+	if (strcmp (s, messages[i][1]) != 0)
+	  {
+	    fprintf (stderr, "gettext (\"%s\") returned: %s\n",
+		     messages[i][0], s);
+	    result = 1;
+	  }
+      }
+
+  /* The second lookup of the same message is answered from the cache.  */
+  gettext ("one");
+  gettext ("one");
+
+  libintl_get_cache_stats (&stats);
+  if (stats.capacity != 4)
+    {
+      fprintf (stderr, "capacity = %lu\n", (unsigned long) stats.capacity);
+      result = 1;
+    }
+  if (stats.entries > 4)
+    {
+      fprintf (stderr, "entries = %lu\n", (unsigned long) stats.entries);
+      result = 1;
+    }
+  if (stats.evictions == 0)
+    {
+      fprintf (stderr, "no evictions\n");
+      result = 1;
+    }
+  if (stats.misses < 12)
+    {
+      fprintf (stderr, "misses = %lu\n", stats.misses);
+      result = 1;
+    }
+  if (stats.hits == 0)
+    {
+      fprintf (stderr, "no hits\n");
+      result = 1;
+    }
+
+  return result;
+}
@@ -0,0 +1,84 @@
+/* Test program, used by the gettext-11 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+#include "check-prg.h"
+
+int
+main (int argc, char *argv[])
+{
+  static const char *layers[] = { "tstoverride", "tstbase", NULL };
+  static const char *no_layers[] = { NULL };
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  bindtextdomain ("tstbase", ".");
+  bindtextdomain ("tstoverride", ".");
+  textdomain ("tstproduct");
+
+  if (libintl_bind_textdomain_layers ("tstproduct", layers) != 0)
+    {
+      fprintf (stderr, "libintl_bind_textdomain_layers failed\n");
+      return 1;
+    }
+
+  /* The override layer shadows the base layer.  */
+  check (1, gettext ("cheese"), "camembert");
+  check (2, gettext ("cheese"), "camembert");
+  /* Messages that the override layer lacks come from the base layer.  */
+  check (3, gettext ("bread"), "pain");
+  check (4, gettext ("bread"), "pain");
+  /* Each layer uses its own plural formula and plural forms.  */
+  check (5, ngettext ("one file", "%d files", 1), "un document");
+  check (6, ngettext ("one file", "%d files", 2), "%d documents");
+  /* Messages that no layer has stay untranslated.  */
+  check (7, gettext ("butter"), "butter");
+  /* The layers themselves are ordinary domains.  */
+  check (8, dgettext ("tstbase", "cheese"), "fromage");
+
+  /* Changing the layers flushes the translations looked up so far.  */
+  layers[0] = "tstbase";
+  layers[1] = NULL;
+  libintl_bind_textdomain_layers ("tstproduct", layers);
+  check (9, gettext ("cheese"), "fromage");
+
+  /* An empty list turns the domain back into an ordinary domain.  */
+  libintl_bind_textdomain_layers ("tstproduct", no_layers);
+  check (10, gettext ("cheese"), "cheese");
+
+  return result;
+}
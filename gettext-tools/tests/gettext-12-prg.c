@@ -0,0 +1,154 @@
+/* Test program, used by the gettext-12 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+/* Messages sharing a long common prefix, as is typical in user interfaces,
+   and as hashes poorly with hashpjw.  */
+static const char *messages[][2] =
+{
+  { "The document could not be saved because "
+    "the disk is full.",
+    "Impossible d'enregistrer le document car "
+    "le disque est plein." },
+  { "The document could not be saved because "
+    "the file is read-only.",
+    "Impossible d'enregistrer le document car "
+    "le fichier est en lecture seule." },
+  { "The document could not be saved because "
+    "the folder does not exist.",
+    "Impossible d'enregistrer le document car "
+    "le dossier n'existe pas." },
+  { "The document could not be saved because "
+    "the network connection was interrupted.",
+    "Impossible d'enregistrer le document car "
+    "la connexion au serveur est interrompue." },
+  { "The document could not be saved because "
+    "another program is using it.",
+    "Impossible d'enregistrer le document car "
+    "un autre programme l'utilise." },
+  { "The document could not be saved because "
+    "you do not have the required permissions.",
+    "Impossible d'enregistrer le document car "
+    "vous n'avez pas les droits requis." },
+  { "The document could not be saved because "
+    "the file name is too long.",
+    "Impossible d'enregistrer le document car "
+    "le nom du fichier est trop long." },
+  { "The document could not be saved because "
+    "the file name contains forbidden characters.",
+    "Impossible d'enregistrer le document car "
+    "le nom du fichier contient des signes interdits." },
+  { "The document could not be saved because "
+    "the remote server is down.",
+    "Impossible d'enregistrer le document car "
+    "le serveur distant est hors service." },
+  { "The document could not be saved because "
+    "your quota is used up.",
+    "Impossible d'enregistrer le document car "
+    "votre quota est atteint." },
+  { "The document could not be saved because "
+    "the medium is missing.",
+    "Impossible d'enregistrer le document car "
+    "le support est absent." },
+  { "The document could not be saved because "
+    "an unknown error occurred.",
+    "Impossible d'enregistrer le document car "
+    "une erreur inconnue s'est produite." }
+};
+
+static int result;
+
+static void
+check (const char *domain, const char *s, const char *expected)
+{
+  if (strcmp (s, expected) != 0)
+    {
+      fprintf (stderr, "%s: lookup returned: %s\n", domain, s);
+      result = 1;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  /* The same catalog, compiled in the default format, in both byte
+     orders, and without hash tables.  */
+  static const char *domains[] =
+    { "tstdefault", "tstbig", "tstlittle", "tstnohash" };
+  size_t d;
+  size_t i;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+
+  for (d = 0; d < sizeof (domains) / sizeof (domains[0]); d++)
+    {
+      const char *domain = domains[d];
+
+      bindtextdomain (domain, ".");
+
+      for (i = 0; i < sizeof (messages) / sizeof (messages[0]); i++)
+	check (domain, dgettext (domain, messages[i][0]), messages[i][1]);
+
+      /* A common prefix of the messages, which is a message itself.  */
+      check (domain, dgettext (domain, "The document could not be saved"),
+	     "Impossible d'enregistrer le document");
+      /* A message with a context.  */
+      check (domain,
+	     dgettext (domain, "menu\004The document could not be saved"),
+	     "Enregistrement impossible");
+      check (domain,
+	     dngettext (domain,
+			"The document could not be saved because of %d error.",
+			"The document could not be saved because of %d errors.",
+			3),
+	     "Impossible d'enregistrer le document: %d erreurs.");
+
+      /* Messages that are not in the catalog.  */
+      check (domain, dgettext (domain, "The document could not be"),
+	     "The document could not be");
+      check (domain,
+	     dgettext (domain,
+		       "The document could not be saved because the disk is"),
+	     "The document could not be saved because the disk is");
+      check (domain,
+	     dgettext (domain, "toolbar\004The document could not be saved"),
+	     "toolbar\004The document could not be saved");
+    }
+
+  return result;
+}
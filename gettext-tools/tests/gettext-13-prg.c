@@ -0,0 +1,111 @@
+/* Test program, used by the gettext-13 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+/* The plural formulas of the catalogs.  */
+
+static unsigned long int
+slavic (unsigned long int n)
+{
+  return (n%10==1 && n%100!=11 ? 0
+	  : n%10>=2 && n%10<=4 && (n%100<10 || n%100>=20) ? 1
+	  : 2);
+}
+
+static unsigned long int
+arabic (unsigned long int n)
+{
+  return (n==0 ? 0 : n==1 ? 1 : n==2 ? 2
+	  : n%100>=3 && n%100<=10 ? 3 : n%100>=11 ? 4
+	  : 5);
+}
+
+static unsigned long int
+custom (unsigned long int n)
+{
+  return (n % 7 ? (n % 3 || n > 20) + (n / 5) % 2 * 2 : !(n - 14) * 3);
+}
+
+static const struct
+{
+  const char *domain;
+  unsigned long int (*formula) (unsigned long int n);
+} catalogs[] =
+{
+  /* Well-known formulas.  */
+  { "tstslavic", slavic },
+  { "tstarabic", arabic },
+  /* A formula that is evaluated by the compiled instructions.  */
+  { "tstcustom", custom }
+};
+
+int
+main (int argc, char *argv[])
+{
+  int result = 0;
+  int round;
+  size_t i;
+  unsigned long int n;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+
+  for (i = 0; i < sizeof (catalogs) / sizeof (catalogs[0]); i++)
+    bindtextdomain (catalogs[i].domain, ".");
+
+  /* The second round uses the remembered plural form indices and the
+     plural form offsets of the known translations.  */
+  for (round = 0; round < 2; round++)
+    for (i = 0; i < sizeof (catalogs) / sizeof (catalogs[0]); i++)
+      for (n = 0; n < 1000; n++)
+	{
+	  const char *s =
+	    dngettext (catalogs[i].domain, "%d file", "%d files", n);
+	  char expected[20];
+
+	  sprintf (expected, "form %lu", catalogs[i].formula (n));
+	  if (strcmp (s, expected) != 0)
+	    {
+	      fprintf (stderr, "%s: n = %lu returned: %s\n",
+		       catalogs[i].domain, n, s);
+	      result = 1;
+	      break;
+	    }
+	}
+
+  return result;
+}
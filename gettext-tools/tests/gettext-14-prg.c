@@ -0,0 +1,88 @@
+/* Test program, used by the gettext-14 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+#include "check-prg.h"
+
+static void
+check_count (int call, int count, int expected)
+{
+  if (count != expected)
+    {
+      fprintf (stderr, "call %d returned: %d\n", call, count);
+      result = 1;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const char *locales[] = { "de", "xx:fr", "C", NULL };
+  static const char *fr[] = { "fr", NULL };
+  static const char *layers[] = { "tstmissing", "tstpreload", NULL };
+  static const char *fr_FR[] = { "fr_FR", NULL };
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+
+  /* Only the locales that have a catalog count.  */
+  check_count (1, libintl_textdomain_preload ("tstpreload", ".", locales), 1);
+  check_count (2, libintl_textdomain_preload ("tstmissing", ".", fr), 0);
+
+  /* Without a list of locales, the locales of LC_MESSAGES are used.  */
+  textdomain ("tstpreload");
+  check_count (3, libintl_textdomain_preload (NULL, NULL, NULL), 1);
+
+  /* For a layered domain, the catalogs of the layers are loaded.  */
+  libintl_bind_textdomain_layers ("tstproduct", layers);
+  check_count (4, libintl_textdomain_preload ("tstproduct", NULL, fr), 1);
+
+  /* The preloaded catalogs are used by the lookups.  */
+  check (5, gettext ("cheese"), "fromage");
+  check (6, ngettext ("one file", "%d files", 2), "%d fichiers");
+  check (7, dgettext ("tstproduct", "cheese"), "fromage");
+  check (8, dgettext ("tstmissing", "cheese"), "cheese");
+
+  /* The catalogs of the fallback locales are loaded too.  */
+  check_count (9, libintl_textdomain_preload ("tstregion", ".", fr_FR), 2);
+  xsetenv ("LANGUAGE", "fr_FR", 1);
+  check (10, dgettext ("tstregion", "cheese"), "brie");
+  check (11, dngettext ("tstregion", "one file", "%d files", 2),
+         "%d fichiers");
+
+  return result;
+}
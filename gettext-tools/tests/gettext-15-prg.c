@@ -0,0 +1,113 @@
+/* Test program, used by the gettext-15 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+#include "check-prg.h"
+
+/* Return the statistics of the catalog whose file name ends in SUFFIX.  */
+static const struct libintl_catalog_stats *
+find_stats (const struct libintl_catalog_stats *stats, size_t n,
+            const char *suffix)
+{
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    {
+      size_t len = strlen (stats[i].filename);
+
+      if (len >= strlen (suffix)
+          && strcmp (stats[i].filename + len - strlen (suffix), suffix) == 0)
+        return &stats[i];
+    }
+  return NULL;
+}
+
+int
+main (int argc, char *argv[])
+{
+  struct libintl_catalog_stats stats[2];
+  const struct libintl_catalog_stats *mapped;
+  const struct libintl_catalog_stats *read;
+  size_t n;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+  unsetenv ("GETTEXT_MMAP_POLICY");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  bindtextdomain ("tstmapped", ".");
+  bindtextdomain ("tstread", ".");
+
+  if (libintl_get_catalog_stats (NULL, 0) != 0)
+    {
+      fprintf (stderr, "catalogs loaded too early\n");
+      result = 1;
+    }
+
+  /* The policy applies to the catalogs loaded afterwards.  */
+  libintl_set_mmap_policy (LIBINTL_MMAP_POPULATE | LIBINTL_MMAP_WILLNEED);
+  check (1, dgettext ("tstmapped", "cheese"), "fromage");
+  libintl_set_mmap_policy (LIBINTL_MMAP_READ);
+  check (2, dgettext ("tstread", "cheese"), "fromage");
+  check (3, dgettext ("tstmapped", "cheese"), "fromage");
+
+  n = libintl_get_catalog_stats (stats, 2);
+  mapped = find_stats (stats, 2, "/tstmapped.mo");
+  read = find_stats (stats, 2, "/tstread.mo");
+  if (n != 2 || mapped == NULL || read == NULL)
+    {
+      fprintf (stderr, "libintl_get_catalog_stats returned %lu\n",
+               (unsigned long) n);
+      return 1;
+    }
+
+  /* The mapped catalog may have been read if the system lacks mmap().  */
+  if (mapped->mapped_bytes + mapped->read_bytes == 0
+      || (mapped->mapped_bytes > 0
+          && mapped->resident_pages != (size_t)(-1)
+          && mapped->resident_pages == 0))
+    {
+      fprintf (stderr, "wrong statistics for %s\n", mapped->filename);
+      result = 1;
+    }
+  if (read->mapped_bytes != 0 || read->read_bytes == 0
+      || read->resident_pages != (size_t)(-1))
+    {
+      fprintf (stderr, "wrong statistics for %s\n", read->filename);
+      result = 1;
+    }
+
+  return result;
+}
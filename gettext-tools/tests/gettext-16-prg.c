@@ -0,0 +1,62 @@
+/* Test program, used by the gettext-16 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+#include "check-prg.h"
+
+int
+main (int argc, char *argv[])
+{
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  bindtextdomain ("tstbundle1", ".");
+  bindtextdomain ("tstbundle2", ".");
+  bindtextdomain ("tstoutside", ".");
+
+  /* Each domain gets its own catalog from the bundle.  */
+  check (1, dgettext ("tstbundle1", "cheese"), "fromage");
+  check (2, dgettext ("tstbundle2", "cheese"), "camembert");
+  check (3, dngettext ("tstbundle1", "one file", "%d files", 2),
+         "%d fichiers");
+  check (4, dngettext ("tstbundle2", "one file", "%d files", 1),
+         "un document");
+  /* Catalogs of domains that are not in the bundle are read from their
+     files.  */
+  check (5, dgettext ("tstoutside", "cheese"), "fromage");
+
+  return result;
+}
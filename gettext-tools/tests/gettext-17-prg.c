@@ -0,0 +1,159 @@
+/* Test program, used by the gettext-17 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if USE_POSIX_THREADS
+
+#include <pthread.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+/* Number of threads doing lookups.  */
+#define THREAD_COUNT 8
+
+/* Number of lookups per thread.  */
+#define REPEAT_COUNT 10000
+
+/* Set to 1 if the program is not behaving correctly.  */
+int result;
+
+static void
+check (const char *s, const char *expected)
+{
+  if (strcmp (s, expected) != 0)
+    {
+      fprintf (stderr, "lookup returned: %s, expected: %s\n", s, expected);
+      result = 1;
+    }
+}
+
+/* Look up the messages of DOMAIN, converted to UTF-8.  */
+static void
+lookup (const char *domain, unsigned long int i)
+{
+  check (dgettext (domain, "cheese"), "K\303\244se");
+  check (dgettext (domain, "greetings"), "Gr\303\274\303\237e");
+  check (dngettext (domain, "one wish", "%d wishes", i % 3),
+         i % 3 == 1
+         ? "ein Wunsch f\303\274r dich"
+         : "%d W\303\274nsche f\303\274r dich");
+}
+
+static void *
+lookup_thread (void *arg)
+{
+  unsigned long int i;
+
+  for (i = 0; i < REPEAT_COUNT && !result; i++)
+    {
+      lookup ("tstlazy", i);
+      lookup ("tsteager", i);
+    }
+
+  return NULL;
+}
+
+int
+main (int argc, char *argv[])
+{
+  pthread_t threads[THREAD_COUNT];
+  int i;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+  unsetenv ("GETTEXT_EAGER_CONVERSION");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  bindtextdomain ("tstlazy", ".");
+  bind_textdomain_codeset ("tstlazy", "UTF-8");
+  bindtextdomain ("tsteager", ".");
+  bind_textdomain_codeset ("tsteager", "UTF-8");
+  result = 0;
+
+  /* The translations of tstlazy are converted one at a time, those of
+     tsteager all at once.  */
+  libintl_set_eager_conversion (0);
+  check (dgettext ("tstlazy", "cheese"), "K\303\244se");
+  libintl_set_eager_conversion (1);
+
+  for (i = 0; i < THREAD_COUNT; i++)
+    if (pthread_create (&threads[i], NULL, &lookup_thread, NULL))
+      exit (2);
+
+  for (i = 0; i < THREAD_COUNT; i++)
+    if (pthread_join (threads[i], NULL))
+      exit (3);
+
+  /* A second encoding gets its own converted translations.  */
+  bind_textdomain_codeset ("tstlazy", "ISO-8859-1");
+  bind_textdomain_codeset ("tsteager", "ISO-8859-1");
+  check (dgettext ("tstlazy", "greetings"), "Gr\374\337e");
+  check (dgettext ("tsteager", "greetings"), "Gr\374\337e");
+  check (dngettext ("tsteager", "one wish", "%d wishes", 2),
+         "%d W\374nsche f\374r dich");
+
+  /* The sizes in gettext-17-2.po are chosen so that, with a 64-bit size_t,
+     the conversion of "accents" ends exactly at the end of the block that
+     the translations are first converted into.  The conversion of the
+     next one must not start beyond it.  */
+  bindtextdomain ("tstend", ".");
+  bind_textdomain_codeset ("tstend", "UTF-8");
+  check (dgettext ("tstend", "end"), "fin");
+  check (dgettext ("tstend", "accents"),
+         "\303\251\303\251\303\251\303\251\303\251\303\251\303\251\303\251"
+         "\303\251\303\251\303\251\303\251\303\251\303\251\303\251\303\251"
+         "\303\251\303\251\303\251\303\251\303\251\303\251\303\251\303\251"
+         "\303\251\303\251\303\251\303\251\303\251\303\251\303\251\303\251"
+         "\303\251\303\251\303\251\303\251\303\251\303\251\303\251\303\251"
+         "\303\251\303\251\303\251\303\251\303\251\303\251\303\251\303\251"
+         "\303\251\303\251\303\251\303\251\303\251\303\251\303\251\303\251"
+         "\303\251\303\251\303\251\303\251\303\251\303\251\303\251\303\251"
+         "\303\251\303\251\303\251\303\251\303\251\303\251\303\251\303\251"
+         "\303\251\303\251\303\251\303\251\303\251\303\251\303\251\303\251"
+         "\303\251\303\251\303\251\303\251\303\251\303\251\303\251\303\251");
+
+  return result;
+}
+
+#else
+
+/* This test is not executed.  */
+
+int
+main (void)
+{
+  return 77;
+}
+
+#endif
@@ -0,0 +1,70 @@
+/* Test program, used by the gettext-18 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+#include "check-prg.h"
+
+int
+main (int argc, char *argv[])
+{
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  /* The first locales have no catalogs.  */
+  xsetenv ("LANGUAGE", "xx_YY.UTF-8@zz:de:fr", 1);
+  bindtextdomain ("tstpresent", ".");
+  bindtextdomain ("tstmissing", ".");
+  bindtextdomain ("tstlater", ".");
+
+  check (1, dgettext ("tstmissing", "cheese"), "cheese");
+  check (2, dgettext ("tstpresent", "cheese"), "fromage");
+
+  /* Install a catalog after the directory was looked at.  Like a change of
+     the bindings, a change of the default domain signals that the set of
+     catalogs may have changed.  */
+  if (rename ("fr/LC_MESSAGES/tstlater.tmp", "fr/LC_MESSAGES/tstlater.mo")
+      != 0)
+    {
+      fprintf (stderr, "cannot install tstlater.mo\n");
+      return 1;
+    }
+  textdomain ("tstlater");
+  check (3, gettext ("cheese"), "fromage");
+  check (4, dgettext ("tstmissing", "cheese"), "cheese");
+
+  return result;
+}
@@ -0,0 +1,117 @@
+/* Test program, used by the gettext-19 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+#include "check-prg.h"
+
+int
+main (int argc, char *argv[])
+{
+  struct libintl_context *fr;
+  struct libintl_context *de;
+  struct libintl_context *xx;
+  struct libintl_context *current;
+  struct libintl_context *fr_FR;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  xsetenv ("LANGUAGE", "fr", 1);
+  textdomain ("tstctx");
+  bindtextdomain ("tstctx", ".");
+  bind_textdomain_codeset ("tstctx", "UTF-8");
+
+  fr = libintl_context_create ("fr");
+  de = libintl_context_create ("de");
+  xx = libintl_context_create ("xx:C:de");
+  current = libintl_context_create (NULL);
+  if (fr == NULL || de == NULL || xx == NULL || current == NULL)
+    {
+      fprintf (stderr, "cannot create the translation contexts\n");
+      return 1;
+    }
+
+  check (1, libintl_context_dgettext (fr, "tstctx", "cheese"), "fromage");
+  check (2, libintl_context_dgettext (de, "tstctx", "cheese"), "K\303\244se");
+  check (3, libintl_context_dgettext (de, NULL, "cheese"), "K\303\244se");
+  /* The locales after "C" are not consulted.  */
+  check (4, libintl_context_dgettext (xx, "tstctx", "cheese"), "cheese");
+  check (5, libintl_context_dgettext (current, "tstctx", "cheese"),
+         "fromage");
+  check (6, libintl_context_dngettext (fr, "tstctx", "one file", "%d files",
+                                       1),
+         "un fichier");
+  check (7, libintl_context_dngettext (fr, "tstctx", "one file", "%d files",
+                                       2),
+         "%d fichiers");
+  check (8, libintl_context_dngettext (xx, "tstctx", "one file", "%d files",
+                                       2),
+         "%d files");
+  check (9, libintl_context_dgettext (fr, "tstnone", "cheese"), "cheese");
+
+  /* The contexts do not change what gettext() does.  */
+  check (10, gettext ("cheese"), "fromage");
+
+  /* A change of the bindings is seen by the contexts.  */
+  bind_textdomain_codeset ("tstctx", "ISO-8859-1");
+  check (11, libintl_context_dgettext (de, "tstctx", "cheese"), "K\344se");
+  bindtextdomain ("tstctx", "nowhere");
+  check (12, libintl_context_dgettext (fr, "tstctx", "cheese"), "cheese");
+
+  /* The catalogs of the fallback locales are consulted after a partial
+     catalog of the region.  */
+  bindtextdomain ("tstctxregion", ".");
+  fr_FR = libintl_context_create ("fr_FR");
+  if (fr_FR == NULL)
+    {
+      fprintf (stderr, "cannot create the translation contexts\n");
+      return 1;
+    }
+  check (13, libintl_context_dgettext (fr_FR, "tstctxregion", "cheese"),
+         "brie");
+  check (14, libintl_context_dngettext (fr_FR, "tstctxregion",
+                                        "one file", "%d files", 2),
+         "%d fichiers");
+
+  libintl_context_free (fr);
+  libintl_context_free (de);
+  libintl_context_free (xx);
+  libintl_context_free (current);
+  libintl_context_free (fr_FR);
+
+  return result;
+}
@@ -0,0 +1,111 @@
+/* Test program, used by the gettext-20 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+#include "check-prg.h"
+
+int
+main (int argc, char *argv[])
+{
+  struct libintl_catalog *fr;
+  struct libintl_catalog *de_utf8;
+  struct libintl_catalog *de_latin1;
+  struct libintl_catalog *xx;
+  struct libintl_catalog *current;
+  struct libintl_catalog *fr_FR;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  xsetenv ("LANGUAGE", "fr", 1);
+  textdomain ("tstcat");
+  bindtextdomain ("tstcat", ".");
+
+  fr = libintl_open_catalog ("tstcat", "fr", NULL);
+  de_utf8 = libintl_open_catalog ("tstcat", "de", "UTF-8");
+  de_latin1 = libintl_open_catalog ("tstcat", "xx:de", "ISO-8859-1");
+  xx = libintl_open_catalog ("tstcat", "xx", NULL);
+  current = libintl_open_catalog (NULL, NULL, NULL);
+  if (fr == NULL || de_utf8 == NULL || de_latin1 == NULL || xx == NULL
+      || current == NULL)
+    {
+      fprintf (stderr, "cannot open the message catalogs\n");
+      return 1;
+    }
+
+  check (1, libintl_handle_gettext (fr, "cheese"), "fromage");
+  check (2, libintl_handle_gettext (de_utf8, "cheese"), "K\303\244se");
+  check (3, libintl_handle_gettext (de_latin1, "cheese"), "K\344se");
+  check (4, libintl_handle_gettext (xx, "cheese"), "cheese");
+  check (5, libintl_handle_gettext (current, "cheese"), "fromage");
+  check (6, libintl_handle_ngettext (fr, "one file", "%d files", 1),
+         "un fichier");
+  check (7, libintl_handle_ngettext (fr, "one file", "%d files", 2),
+         "%d fichiers");
+  check (8, libintl_handle_ngettext (xx, "one file", "%d files", 2),
+         "%d files");
+  check (9, libintl_handle_gettext (fr, "butter"), "butter");
+
+  /* The handles are not affected by later changes of the bindings.  */
+  bindtextdomain ("tstcat", "nowhere");
+  bind_textdomain_codeset ("tstcat", "UTF-8");
+  check (10, libintl_handle_gettext (fr, "cheese"), "fromage");
+  check (11, libintl_handle_gettext (de_latin1, "cheese"), "K\344se");
+  check (12, gettext ("cheese"), "cheese");
+
+  /* The catalogs of the fallback locales are consulted after a partial
+     catalog of the region.  */
+  bindtextdomain ("tstcatregion", ".");
+  fr_FR = libintl_open_catalog ("tstcatregion", "fr_FR", NULL);
+  if (fr_FR == NULL)
+    {
+      fprintf (stderr, "cannot open the message catalogs\n");
+      return 1;
+    }
+  check (13, libintl_handle_gettext (fr_FR, "cheese"), "brie");
+  check (14, libintl_handle_ngettext (fr_FR, "one file", "%d files", 2),
+         "%d fichiers");
+
+  libintl_close_catalog (fr);
+  libintl_close_catalog (de_utf8);
+  libintl_close_catalog (de_latin1);
+  libintl_close_catalog (xx);
+  libintl_close_catalog (current);
+  libintl_close_catalog (fr_FR);
+
+  return result;
+}
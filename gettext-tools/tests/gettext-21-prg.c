@@ -0,0 +1,143 @@
+/* Test program, used by the gettext-21 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+#include "check-prg.h"
+
+int
+main (int argc, char *argv[])
+{
+  static const char *words[][2] =
+    {
+      { "apple", "pomme" }, { "bread", "pain" }, { "butter", "beurre" },
+      { "cheese", "fromage" }, { "egg", "oeuf" }, { "milk", "lait" },
+      { "pear", "poire" }, { "wine", "vin" }, { "salt", "salt" }
+    };
+  struct libintl_batch_message messages[5 + 3 * 9];
+  struct libintl_batch_message region[2];
+  size_t count;
+  size_t found;
+  size_t i;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  xsetenv ("LANGUAGE", "fr", 1);
+  textdomain ("tstbatch");
+  bindtextdomain ("tstbatch", ".");
+
+  memset (messages, 0, sizeof (messages));
+  messages[0].msgctxt = "month";
+  messages[0].msgid = "May";
+  messages[1].msgctxt = "verb";
+  messages[1].msgid = "May";
+  messages[2].msgctxt = "noun";
+  messages[2].msgid = "May";
+  messages[3].msgid = "one file";
+  messages[3].msgid_plural = "%d files";
+  messages[3].n = 1;
+  messages[4].msgid = "one file";
+  messages[4].msgid_plural = "%d files";
+  messages[4].n = 3;
+  /* Enough messages for the lookups to be prepared ahead.  */
+  count = 5;
+  for (i = 0; i < 3 * 9; i++)
+    messages[count++].msgid = words[i % 9][0];
+
+  found = libintl_dcgettext_batch (NULL, messages, count, LC_MESSAGES);
+  if (found != count - 4)
+    {
+      fprintf (stderr, "found %lu translations\n", (unsigned long) found);
+      result = 1;
+    }
+
+  check (1, messages[0].translation, "mai");
+  check (2, messages[1].translation, "peut");
+  check (3, messages[2].translation, "May");
+  check (4, messages[3].translation, "un fichier");
+  check (5, messages[4].translation, "%d fichiers");
+  for (i = 0; i < 3 * 9; i++)
+    check (6 + i, messages[5 + i].translation, words[i % 9][1]);
+
+  /* The results are those of the functions that look up a single
+     message.  */
+  for (i = 5; i < count; i++)
+    check (100 + i, messages[i].translation, gettext (messages[i].msgid));
+
+  /* A second call finds the same translations, now among the known
+     ones.  */
+  for (i = 0; i < count; i++)
+    messages[i].translation = NULL;
+  found = libintl_dcgettext_batch (NULL, messages, count, LC_MESSAGES);
+  if (found != count - 4)
+    {
+      fprintf (stderr, "found %lu translations\n", (unsigned long) found);
+      result = 1;
+    }
+  check (301, messages[0].translation, "mai");
+  check (302, messages[2].translation, "May");
+  check (303, messages[4].translation, "%d fichiers");
+  for (i = 0; i < 3 * 9; i++)
+    check (306 + i, messages[5 + i].translation, words[i % 9][1]);
+
+  /* The catalogs of the fallback locales are consulted after a partial
+     catalog of the region.  */
+  bindtextdomain ("tstbatchregion", ".");
+  xsetenv ("LANGUAGE", "fr_FR", 1);
+  memset (region, 0, sizeof (region));
+  region[0].msgid = "cheese";
+  region[1].msgid = "one file";
+  region[1].msgid_plural = "%d files";
+  region[1].n = 2;
+  found = libintl_dcgettext_batch ("tstbatchregion", region, 2, LC_MESSAGES);
+  if (found != 2)
+    result = 1;
+  check (400, region[0].translation, "brie");
+  check (401, region[1].translation, "%d fichiers");
+  xsetenv ("LANGUAGE", "fr", 1);
+
+  /* Without a catalog, the messages are returned untranslated.  */
+  found = libintl_dcgettext_batch ("tstnone", messages, count, LC_MESSAGES);
+  if (found != 0)
+    result = 1;
+  check (200, messages[0].translation, "May");
+  check (201, messages[3].translation, "one file");
+  check (202, messages[4].translation, "%d files");
+  check (203, messages[5].translation, "apple");
+
+  return result;
+}
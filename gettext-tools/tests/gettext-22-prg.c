@@ -0,0 +1,99 @@
+/* Test program, used by the gettext-22 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+#include "check-prg.h"
+
+static void
+check_count (int call, int count, int expected)
+{
+  if (count != expected)
+    {
+      fprintf (stderr, "call %d returned: %d\n", call, count);
+      result = 1;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  const char *old_translation;
+  struct libintl_cache_stats stats;
+  unsigned long int hits;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  xsetenv ("LANGUAGE", "fr", 1);
+  textdomain ("tstreload");
+  bindtextdomain ("tstreload", ".");
+  bindtextdomain ("tstother", ".");
+  libintl_count_cache_hits (1);
+
+  old_translation = gettext ("cheese");
+  check (1, old_translation, "fromage");
+  check (2, ngettext ("one file", "%d files", 2), "%d fichiers");
+  check (3, dgettext ("tstother", "cheese"), "fromage");
+
+  /* Nothing to do while the files are unchanged.  */
+  check_count (4, libintl_reload_domain ("tstreload"), 0);
+  check_count (5, libintl_reload_domain ("tstother"), 0);
+
+  /* Install a new version of the catalog.  */
+  if (rename ("tstreload.mo", "fr/LC_MESSAGES/tstreload.mo") != 0)
+    {
+      fprintf (stderr, "cannot install the new message catalog\n");
+      return 1;
+    }
+  check_count (6, libintl_reload_domain (NULL), 1);
+
+  check (7, gettext ("cheese"), "camembert");
+  check (8, ngettext ("one file", "%d files", 1), "un dossier");
+  check (9, ngettext ("one file", "%d files", 2), "%d dossiers");
+
+  /* The translation returned earlier is still valid.  */
+  check (10, old_translation, "fromage");
+
+  /* The other domain is still cached.  */
+  libintl_get_cache_stats (&stats);
+  hits = stats.hits;
+  check (11, dgettext ("tstother", "cheese"), "fromage");
+  libintl_get_cache_stats (&stats);
+  check_count (12, stats.hits - hits, 1);
+
+  return result;
+}
@@ -0,0 +1,121 @@
+/* Test program, used by the gettext-23 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+#include "check-prg.h"
+
+static void
+check_count (int call, unsigned long int count, unsigned long int expected)
+{
+  if (count != expected)
+    {
+      fprintf (stderr, "call %d returned: %lu\n", call, count);
+      result = 1;
+    }
+}
+
+/* Return the counters of DOMAINNAME, or NULL.  */
+static const struct libintl_domain_stats *
+find_stats (const char *domainname)
+{
+  static struct libintl_domain_stats stats[10];
+  size_t n = libintl_get_domain_stats (stats, 10);
+  size_t i;
+
+  for (i = 0; i < n && i < 10; i++)
+    if (strcmp (stats[i].domainname, domainname) == 0)
+      return &stats[i];
+  return NULL;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const struct libintl_domain_stats *stats;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  xsetenv ("LANGUAGE", "fr", 1);
+  textdomain ("tststats");
+  bindtextdomain ("tststats", ".");
+  bindtextdomain ("tstnone", ".");
+
+  /* The environment variable GETTEXT_DOMAIN_STATS enables the counting.  */
+  check (1, gettext ("cheese"), "fromage");
+  check (2, gettext ("cheese"), "fromage");
+  check (3, gettext ("cheese"), "fromage");
+  check (4, gettext ("butter"), "butter");
+  check (5, dgettext ("tstnone", "cheese"), "cheese");
+
+  stats = find_stats ("tststats");
+  if (stats == NULL)
+    {
+      fprintf (stderr, "no counters for tststats\n");
+      return 1;
+    }
+  /* Whether the repeated lookups are found in the cache depends on the
+     platform.  */
+  check_count (6, stats->cache_hits + stats->catalog_lookups, 4);
+  check_count (7, stats->untranslated, 1);
+  check_count (8, stats->catalogs_loaded, 1);
+
+  stats = find_stats ("tstnone");
+  if (stats == NULL)
+    {
+      fprintf (stderr, "no counters for tstnone\n");
+      return 1;
+    }
+  check_count (9, stats->cache_hits, 0);
+  check_count (10, stats->catalog_lookups, 1);
+  check_count (11, stats->untranslated, 1);
+  check_count (12, stats->catalogs_loaded, 0);
+  if (stats->catalogs_missing == 0)
+    {
+      fprintf (stderr, "no missing catalogs for tstnone\n");
+      result = 1;
+    }
+
+  /* No counting while it is disabled.  */
+  libintl_count_domain_stats (0);
+  check (13, gettext ("butter"), "butter");
+  stats = find_stats ("tststats");
+  check_count (14, stats->untranslated, 1);
+  libintl_count_domain_stats (1);
+
+  return result;
+}
@@ -0,0 +1,67 @@
+/* Test program, used by the gettext-24 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+int
+main ()
+{
+  struct stat statbuf;
+  int i;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  setlocale (LC_ALL, "C");
+  textdomain ("tstlog");
+  bindtextdomain ("tstlog", ".");
+
+  for (i = 0; i < 3; i++)
+    {
+      gettext ("cheese");
+      ngettext ("one file", "%d files", i);
+      dgettext ("tstother", "cheese");
+      gettext ("food\004butter");
+      gettext ("two\nlines");
+    }
+
+  /* The log is written at exit.  */
+  if (stat ("gt-24.log", &statbuf) == 0 && statbuf.st_size > 0)
+    {
+      fprintf (stderr, "the log was written too early\n");
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,40 @@
+/* Test program, used by the gettext-26 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* The alias path of libintl is fixed when it is built.  Compile its alias
+   lookup here once more, with the current directory as alias path, so
+   that the locale.alias and locale.alias.idx files of the test are
+   used.  */
+#define LOCALE_ALIAS_PATH "."
+#define _nl_expand_alias test_expand_alias
+#include "localealias.c"
+
+/* Expand each of the locale aliases given as arguments, and print the
+   locale names, one per line, or "-" for those that are not aliases.  */
+int
+main (int argc, char *argv[])
+{
+  int i;
+
+  for (i = 1; i < argc; i++)
+    {
+      const char *value = test_expand_alias (argv[i]);
+
+      printf ("%s\n", value != NULL ? value : "-");
+    }
+
+  return 0;
+}
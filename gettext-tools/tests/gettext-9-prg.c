@@ -0,0 +1,122 @@
+/* Test program, used by the gettext-9 test.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if USE_POSIX_THREADS
+
+#include <pthread.h>
+#include "xsetenv.h"
+
+/* Make sure we use the included libintl, not the system's one. */
+#undef _LIBINTL_H
+#include "libgnuintl.h"
+
+/* Number of threads doing lookups.  */
+#define THREAD_COUNT 8
+
+/* Number of lookups per thread.  */
+#define REPEAT_COUNT 100000
+
+/* Set to 1 if the program is not behaving correctly.  */
+int result;
+
+static void
+check (const char *s, const char *expected)
+{
+  if (strcmp (s, expected) != 0)
+    {
+      fprintf (stderr, "lookup returned: %s, expected: %s\n", s, expected);
+      result = 1;
+    }
+}
+
+static void *
+lookup_thread (void *arg)
+{
+  unsigned long int i;
+
+  for (i = 0; i < REPEAT_COUNT && !result; i++)
+    {
+      check (dgettext ("tstlookup", "cheese"), "fromage");
+      check (dgettext ("tstlookup", "bread"), "pain");
+      check (dngettext ("tstlookup", "one file", "%d files", i % 3),
+	     i % 3 > 1 ? "%d fichiers" : "un fichier");
+      check (dgettext ("tstlookup", "butter"), "butter");
+    }
+
+  return NULL;
+}
+
+int
+main (int argc, char *argv[])
+{
+  pthread_t threads[THREAD_COUNT];
+  int i;
+
+  /* Clean up environment.  */
+  unsetenv ("LANGUAGE");
+  unsetenv ("LC_ALL");
+  unsetenv ("LC_MESSAGES");
+  unsetenv ("LC_CTYPE");
+  unsetenv ("LANG");
+  unsetenv ("OUTPUT_CHARSET");
+
+  xsetenv ("LC_ALL", argv[1], 1);
+  setlocale (LC_ALL, "");
+  bindtextdomain ("tstlookup", ".");
+  result = 0;
+
+  for (i = 0; i < THREAD_COUNT; i++)
+    if (pthread_create (&threads[i], NULL, &lookup_thread, NULL))
+      exit (2);
+
+  /* Meanwhile, change the default domain back and forth.  This must not
+     disturb the lookups with an explicit domain.  */
+  for (i = 0; i < 1000; i++)
+    {
+      const char *s;
+
+      textdomain (i % 2 ? "tstlookup" : "tstother");
+      s = gettext ("cheese");
+      check (s, i % 2 ? "fromage" : "cheese");
+    }
+
+  for (i = 0; i < THREAD_COUNT; i++)
+    if (pthread_join (threads[i], NULL))
+      exit (3);
+
+  return result;
+}
+
+#else
+
+/* This test is not executed.  */
+
+int
+main (void)
+{
+  return 77;
+}
+
+#endif
@@ -19,6 +19,7 @@
 #endif
 
 #include <getopt.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -31,6 +32,7 @@
 #include "relocatable.h"
 #include "basename.h"
 #include "propername.h"
+#include "batch-record.h"
 #include "xsetenv.h"
 
 #define HAVE_SETLOCALE 1
@@ -40,12 +42,17 @@
 
 #define _(str) gettext (str)
 
+/* The character that terminates each record in batch mode.  */
+static char record_delimiter;
+
 /* Long options.  */
 static const struct option long_options[] =
 {
+  { "batch", no_argument, NULL, CHAR_MAX + 1 },
   { "domain", required_argument, NULL, 'd' },
   { "env", required_argument, NULL, '=' },
   { "help", no_argument, NULL, 'h' },
+  { "null", no_argument, NULL, '0' },
   { "version", no_argument, NULL, 'V' },
   { NULL, 0, NULL, 0 }
 };
@@ -56,6 +63,8 @@ static void usage (int __status)
      __attribute__ ((noreturn))
 #endif
 ;
+static unsigned long get_count (const char *count);
+static void batch (const char *domain);
 
 int
 main (int argc, char *argv[])
@@ -67,11 +76,13 @@ main (int argc, char *argv[])
   unsigned long n;
 
   /* Default values for command line options.  */
+  bool do_batch = false;
   bool do_help = false;
   bool do_version = false;
   bool environ_changed = false;
   const char *domain = getenv ("TEXTDOMAIN");
   const char *domaindir = getenv ("TEXTDOMAINDIR");
+  record_delimiter = '\n';
 
   /* Set program name for message texts.  */
   set_program_name (argv[0]);
@@ -89,12 +100,15 @@ main (int argc, char *argv[])
   atexit (close_stdout);
 
   /* Parse command line options.  */
-  while ((optchar = getopt_long (argc, argv, "+d:hV", long_options, NULL))
+  while ((optchar = getopt_long (argc, argv, "+0d:hV", long_options, NULL))
          != EOF)
     switch (optchar)
     {
     case '\0':          /* Long option.  */
       break;
+    case '0':
+      record_delimiter = '\0';
+      break;
     case 'd':
       domain = optarg;
       break;
@@ -104,6 +118,9 @@ main (int argc, char *argv[])
     case 'V':
       do_version = true;
       break;
+    case CHAR_MAX + 1:  /* --batch */
+      do_batch = true;
+      break;
     case '=':
       {
         /* Undocumented option --env sets an environment variable.  */
@@ -146,6 +163,34 @@ There is NO WARRANTY, to the extent permitted by law.\n\
   if (do_help)
     usage (EXIT_SUCCESS);
 
+  /* In batch mode, the messages and counts come from standard input.  */
+  if (do_batch)
+    {
+      switch (argc - optind)
+        {
+        default:
+          error (EXIT_FAILURE, 0, _("too many arguments"));
+
+        case 1:
+          domain = argv[optind++];
+          /* FALLTHROUGH */
+
+        case 0:
+          break;
+        }
+
+      /* If no domain name is given we don't translate.  */
+      if (domain == NULL || domain[0] == '\0')
+        domain = NULL;
+      else
+        /* Bind domain to appropriate directory.  */
+        if (domaindir != NULL && domaindir[0] != '\0')
+          bindtextdomain (domain, domaindir);
+
+      batch (domain);
+      exit (EXIT_SUCCESS);
+    }
+
   /* More optional command line options.  */
   if (argc - optind <= 2)
     error (EXIT_FAILURE, 0, _("missing arguments"));
@@ -168,19 +213,7 @@ There is NO WARRANTY, to the extent permitted by law.\n\
   while (optind < argc)
     {
       count = argv[optind++];
-
-      {
-        char *endp;
-        unsigned long tmp_val;
-
-        errno = 0;
-        tmp_val = strtoul (count, &endp, 10);
-        if (errno == 0 && count[0] != '\0' && endp[0] == '\0')
-          n = tmp_val;
-        else
-          /* When COUNT is not valid, use plural.  */
-          n = 99;
-      }
+      n = get_count (count);
 
       /* If no domain name is given we don't translate, and we use English
          plural form handling.  */
@@ -230,3 +263,52 @@ Standard search directory: %s\n"), LOCALEDIR);
 
   exit (status);
 }
+
+
+/* Converts the COUNT argument to a number.  */
+static unsigned long
+get_count (const char *count)
+{
+  char *endp;
+  unsigned long tmp_val;
+
+  errno = 0;
+  tmp_val = strtoul (count, &endp, 10);
+  if (errno == 0 && count[0] != '\0' && endp[0] == '\0')
+    return tmp_val;
+  else
+    /* When COUNT is not valid, use plural.  */
+    return 99;
+}
+
+
+/* Translates the MSGID, MSGID-PLURAL, COUNT triples read from standard
+   input, until end of file.  DOMAIN is NULL if the messages shall not be
+   translated.  */
+static void
+batch (const char *domain)
+{
+  char *lines[3] = { NULL, NULL, NULL };
+  size_t sizes[3] = { 0, 0, 0 };
+
+  while (read_record (&lines[0], &sizes[0], record_delimiter))
+    {
+      unsigned long n;
+
+      if (!read_record (&lines[1], &sizes[1], record_delimiter)
+          || !read_record (&lines[2], &sizes[2], record_delimiter))
+        error (EXIT_FAILURE, 0, _("missing arguments"));
+
+      n = get_count (lines[2]);
+
+      /* Write out the result.  */
+      if (domain == NULL)
+        write_record (n == 1 ? lines[0] : lines[1], record_delimiter);
+      else
+        write_record (dngettext (domain, lines[0], lines[1], n),
+                      record_delimiter);
+    }
+  free (lines[0]);
+  free (lines[1]);
+  free (lines[2]);
+}